@@ -0,0 +1,107 @@
+#include "aabbkernel.h"
+#include "collision.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+* Micro-benchmark for the batched AABB kernel against two scalar loops, a Rectangle per
+* block through CheckCollisionAABB and the same packed arrays the kernel reads. The sim
+* uses it for the bricks a ball overlaps (BrickField::ForEachTouchingBrick), 8 at a time.
+* Every ball is tested against one packed row of 16 blocks, the results of all paths are
+* compared so this doubles as a correctness check for the SIMD code.
+*
+* Usage: breakout_kernel_bench [--iterations N]
+*/
+int main(int argc, char** argv)
+{
+	long long iterations { 2'000'000 };
+	if (argc == 3 && std::strcmp(argv[1], "--iterations") == 0)
+	{
+		iterations = std::atoll(argv[2]);
+	}
+
+	constexpr size_t numBlocks { 16 };
+	constexpr size_t numBalls { 1024 };
+	constexpr float blockWidth { 30.0f };
+	constexpr float blockHeight { 16.0f };
+	constexpr float blockPadding { 2.0f };
+
+	std::vector<Rectangle> blocks;
+	std::vector<float> minX, minY, maxX, maxY;
+	for (size_t i { 0 }; i < numBlocks; i++)
+	{
+		const Rectangle block { i * (blockWidth + blockPadding), 30.0f, blockWidth, blockHeight };
+		blocks.push_back(block);
+
+		minX.push_back(block.x);
+		minY.push_back(block.y);
+		maxX.push_back(block.x + block.width);
+		maxY.push_back(block.y + block.height);
+	}
+
+	// Balls scattered around the row so roughly half of them touch something
+	std::mt19937 random { 1234 };
+	std::uniform_real_distribution<float> ballX { -12.0f, numBlocks * (blockWidth + blockPadding) };
+	std::uniform_real_distribution<float> ballY { 10.0f, 56.0f };
+	std::vector<Rectangle> balls;
+	for (size_t i { 0 }; i < numBalls; i++)
+	{
+		balls.push_back(Rectangle { ballX(random), ballY(random), 12.0f, 12.0f });
+	}
+
+	auto ScalarCollider { [&](const Rectangle& ball) {
+		uint32_t mask { 0 };
+		for (size_t block { 0 }; block < blocks.size(); block++)
+		{
+			if (CheckCollisionAABB(ball, blocks[block]))
+			{
+				mask |= 1u << block;
+			}
+		}
+		return mask;
+		} };
+
+	auto ScalarPacked { [&](const Rectangle& ball) {
+		return OverlapMaskAABBScalar(ball, minX.data(), minY.data(), maxX.data(), maxY.data(), numBlocks);
+		} };
+
+	auto Kernel { [&](const Rectangle& ball) {
+		return OverlapMaskAABB(ball, minX.data(), minY.data(), maxX.data(), maxY.data(), numBlocks);
+		} };
+
+	for (const Rectangle& ball : balls)
+	{
+		const uint32_t expected { ScalarCollider(ball) };
+		if (ScalarPacked(ball) != expected || Kernel(ball) != expected)
+		{
+			std::fprintf(stderr, "mask mismatch for ball at %.2f, %.2f\n", ball.x, ball.y);
+			return 1;
+		}
+	}
+
+	auto Time { [&](const char* name, auto&& test) {
+		uint32_t checksum { 0 };
+		const auto startTime { std::chrono::steady_clock::now() };
+		for (long long i { 0 }; i < iterations; i++)
+		{
+			checksum += test(balls[i & (numBalls - 1)]);
+		}
+		const auto endTime { std::chrono::steady_clock::now() };
+		const double nanoseconds { std::chrono::duration<double, std::nano>(endTime - startTime).count() };
+		const double perBall { nanoseconds / iterations };
+		std::printf("%-24s %8.2f ns/ball  %8.3f ns/block  (checksum %u)\n", name, perBall, perBall / numBlocks, checksum);
+		return perBall;
+		} };
+
+	std::printf("kernel: %s, %zu blocks per row, %lld iterations\n", OverlapMaskAABBImplementation(), numBlocks, iterations);
+	const double scalarTime { Time("Rectangle + scalar", ScalarCollider) };
+	Time("packed scalar", ScalarPacked);
+	const double kernelTime { Time("OverlapMaskAABB", Kernel) };
+	std::printf("speedup vs Rectangle:    %.2fx\n", scalarTime / kernelTime);
+
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "batchsimulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Follows the lowest ball from the observations, the same rule as the Autoplayer
+static void ChooseActions(const BatchSimulation& batch, std::vector<float>& actions)
+{
+	const std::span<const float> observations { batch.GetObservations() };
+	for (size_t i { 0 }; i < batch.GetCount(); i++)
+	{
+		const float* observation { &observations[i * BatchSimulation::m_ObservationSize] };
+		const float paddleX { observation[0] };
+		const float ballX { observation[3] };
+		const bool hasBall { observation[3 + 4] != 0.0f };
+		actions[i] = !hasBall ? 0.0f : ballX < paddleX - 0.01f ? -1.0f : ballX > paddleX + 0.01f ? 1.0f : 0.0f;
+	}
+}
+
+struct BatchResult
+{
+	double stepsPerSecond { 0.0 };
+	double rewards { 0.0 };
+	long long dones { 0 };
+	std::vector<float> observations;
+};
+
+static BatchResult RunBatch(size_t environments, unsigned int threads, int steps, uint32_t seed)
+{
+	BatchSimulation batch { environments, threads };
+	batch.Reset(seed);
+	std::vector<float> actions(environments, 0.0f);
+	BatchResult result;
+
+	const auto startTime { std::chrono::steady_clock::now() };
+	for (int step { 0 }; step < steps; step++)
+	{
+		ChooseActions(batch, actions);
+		batch.Step(actions);
+
+		for (float reward : batch.GetRewards()) result.rewards += reward;
+		for (uint8_t done : batch.GetDones()) result.dones += done;
+	}
+	const double seconds { std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() };
+
+	result.stepsPerSecond = static_cast<double>(environments) * steps / seconds;
+	result.observations.assign(batch.GetObservations().begin(), batch.GetObservations().end());
+	return result;
+}
+
+/*
+* Steps a batch of games with a simple ball chasing policy at a few thread counts and
+* reports env-steps per second (one game advancing one tick is one env-step). Every thread
+* count has to finish with exactly the same observations as one thread, the games don't
+* share anything so how they're split up must not matter.
+*
+* Usage: breakout_batch_bench [--envs N] [--steps S] [--seed S]
+*/
+int main(int argc, char** argv)
+{
+	size_t environments { 4096 };
+	int steps { 2000 };
+	uint32_t seed { 1 };
+
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--envs") == 0 && i + 1 < argc)
+		{
+			environments = static_cast<size_t>(std::max(1ll, std::atoll(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+		{
+			steps = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--envs N] [--steps S] [--seed S]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const unsigned int hardwareThreads { std::max(1u, std::thread::hardware_concurrency()) };
+	std::printf("%zu games, %d steps, %u hardware threads\n", environments, steps, hardwareThreads);
+	std::printf("%-8s %14s %12s %8s\n", "threads", "env-steps/s", "reward", "dones");
+
+	std::vector<unsigned int> threadCounts { 1 };
+	for (unsigned int threads { 2 }; threads < hardwareThreads; threads *= 2) threadCounts.push_back(threads);
+	if (hardwareThreads > 1) threadCounts.push_back(hardwareThreads);
+
+	BatchResult reference;
+	for (unsigned int threads : threadCounts)
+	{
+		BatchResult result { RunBatch(environments, threads, steps, seed) };
+		std::printf("%-8u %14.0f %12.1f %8lld\n", threads, result.stepsPerSecond, result.rewards, result.dones);
+
+		if (threads == 1)
+		{
+			reference = std::move(result);
+		}
+		else if (result.observations != reference.observations || result.rewards != reference.rewards || result.dones != reference.dones)
+		{
+			std::fprintf(stderr, "%u threads diverged from 1 thread\n", threads);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,378 @@
+#include "simulation.h"
+#include "gamestate.h"
+#include "autoplayer.h"
+#include "level.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+* Benchmarks for the simulation passes and whole ticks, for every combination of brick
+* and ball count asked for. Results go out as JSON so they can be kept per commit and
+* compared, --label is copied into the output for that (e.g. the commit hash).
+*
+* Every sample starts from the same snapshot, a round that has been playing for a few
+* ticks, so passes that change the state (destroying blocks, losing balls) measure the same
+* work each time. Only the pass itself is timed, restoring the snapshot isn't.
+* Each result also has how many overlapping ball pairs the per ball contact cap left
+* unresolved in one iteration (see Simulation::GetDroppedBallContacts).
+*
+* --level plays a level file (see level.h) instead of the classic field, --bricks is ignored.
+*
+* Usage: breakout_bench [--bricks 28,44,60] [--balls 1,16,256] [--iterations N]
+*                       [--level file] [--filter name] [--label text] [--out file]
+*/
+
+struct BenchConfig
+{
+	std::vector<int> bricks { 28, 44, 60 };
+	std::vector<int> balls { 1, 16, 256 };
+	int iterations { 2000 };
+	const char* levelPath { nullptr };
+	const char* filter { nullptr };
+	const char* label { "" };
+	const char* outPath { nullptr };
+};
+
+struct BenchResult
+{
+	std::string name;
+	int bricks;
+	int balls;
+	int liveBricks;
+	int activeBalls;
+	int iterations;
+	int ticksPerIteration;
+	double minNs;
+	double medianNs;
+	double meanNs;
+	double p99Ns;
+
+	// Overlapping ball pairs the contact cap left apart in one iteration, the collision quality lost to keep the pass fast
+	uint64_t droppedBallContacts;
+};
+
+constexpr float TickLength { 1.0f / 120.0f };
+constexpr uint32_t BenchSeed { 12345 };
+constexpr int WarmupTicks { 10 };
+
+static std::vector<int> ParseList(const char* text)
+{
+	std::vector<int> values;
+	const char* item { text };
+	while (*item != '\0')
+	{
+		char* end { nullptr };
+		const long value { std::strtol(item, &end, 10) };
+		if (end == item) break;
+
+		values.push_back(static_cast<int>(value));
+		item = *end == ',' ? end + 1 : end;
+	}
+	return values;
+}
+
+/*
+* A round with the given number of bricks and balls in play. The state and the simulation
+* are kept as the snapshot, Restore copies them back into the working GameState before
+* each sample. The Simulation is copied too since the broadphase and the ball grid
+* live in it.
+*/
+class Scenario
+{
+private:
+	GameState m_Snapshot;
+	std::optional<Simulation> m_SnapshotSimulation;
+	int m_BlocksPerRow { 0 };
+
+public:
+	GameState state;
+	std::optional<Simulation> simulation;
+
+	// level replaces the classic field when it isn't null, bricks is ignored then
+	void Setup(int bricks, int balls, const BrickField* level)
+	{
+		m_BlocksPerRow = std::clamp(bricks / GameState::m_NumBlockRows, 1, GameState::m_MaxBlocksPerRow);
+
+		Simulation setup { state };
+		if (level != nullptr) setup.SetLevel(*level);
+		setup.Init(SimLayout {}, BenchSeed);
+		setup.ResetGame();
+
+		// ResetGame always starts from the first level's row, a level clear respawns the field
+		// at the size we want. The bricks are put straight in place instead of dropping in
+		if (level == nullptr)
+		{
+			state.m_currentBlocksPerRow = std::max(1, m_BlocksPerRow - 2);
+			state.m_GameMode = GameMode::LEVEL_CLEAR;
+			setup.Step(SimInput {}, 0.0f);
+		}
+
+		state.m_Bricks.SetOffsetY(0.0f);
+		state.m_Bricks.SnapPreviousOffset();
+
+		setup.SpawnBalls(balls - 1);
+
+		Autoplayer autoplayer { balls, true };
+		for (int i { 0 }; i < WarmupTicks; i++)
+		{
+			setup.Step(autoplayer.NextInput(state), TickLength);
+		}
+
+		m_Snapshot = state;
+		m_SnapshotSimulation.emplace(setup);
+	}
+
+	void Restore()
+	{
+		state = m_Snapshot;
+		simulation.emplace(*m_SnapshotSimulation);
+	}
+
+	inline int GetBlocksPerRow() const
+	{
+		return m_BlocksPerRow;
+	}
+
+	int CountLiveBricks() const
+	{
+		return static_cast<int>(m_Snapshot.m_Bricks.GetLiveCount());
+	}
+
+	int CountActiveBalls() const
+	{
+		return m_SnapshotSimulation->GetActiveBallCount();
+	}
+};
+
+struct Benchmark
+{
+	const char* name;
+	int ticksPerIteration;
+
+	// Runs untimed after the restore, to set up the one thing this benchmark needs
+	std::function<void(Scenario&)> prepare;
+	std::function<void(Scenario&)> run;
+};
+
+static double Nanoseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// What an empty timed region costs, so tiny passes can be read with it in mind
+static double MeasureTimerOverhead()
+{
+	std::vector<double> samples(10000);
+	for (double& sample : samples)
+	{
+		const auto start { std::chrono::steady_clock::now() };
+		const auto end { std::chrono::steady_clock::now() };
+		sample = Nanoseconds(start, end);
+	}
+	std::sort(samples.begin(), samples.end());
+	return samples[samples.size() / 2];
+}
+
+static BenchResult Run(const Benchmark& benchmark, Scenario& scenario, int bricks, int balls, int iterations)
+{
+	std::vector<double> samples(static_cast<size_t>(iterations));
+	uint64_t droppedBallContacts { 0 };
+	for (double& sample : samples)
+	{
+		scenario.Restore();
+		if (benchmark.prepare) benchmark.prepare(scenario);
+		const uint64_t droppedBefore { scenario.simulation->GetDroppedBallContacts() };
+
+		const auto start { std::chrono::steady_clock::now() };
+		benchmark.run(scenario);
+		const auto end { std::chrono::steady_clock::now() };
+		sample = Nanoseconds(start, end);
+
+		// Every sample starts from the same snapshot, so they all drop the same
+		droppedBallContacts = scenario.simulation->GetDroppedBallContacts() - droppedBefore;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	double total { 0.0 };
+	for (double sample : samples) total += sample;
+
+	BenchResult result;
+	result.name = benchmark.name;
+	result.bricks = bricks;
+	result.balls = balls;
+	result.liveBricks = scenario.CountLiveBricks();
+	result.activeBalls = scenario.CountActiveBalls();
+	result.iterations = iterations;
+	result.ticksPerIteration = benchmark.ticksPerIteration;
+	result.minNs = samples.front();
+	result.medianNs = samples[samples.size() / 2];
+	result.meanNs = total / static_cast<double>(samples.size());
+	result.p99Ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+	result.droppedBallContacts = droppedBallContacts;
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	BenchConfig config;
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bricks") == 0 && i + 1 < argc)
+		{
+			config.bricks = ParseList(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+		{
+			config.balls = ParseList(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			config.iterations = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			config.levelPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			config.filter = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+		{
+			config.label = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			config.outPath = argv[++i];
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--bricks 28,44,60] [--balls 1,16,256] [--iterations N] [--level file] [--filter name] [--label text] [--out file]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	constexpr int secondOfPlayTicks { 120 };
+
+	const std::vector<Benchmark> benchmarks {
+		{ "update_entities", 1, nullptr, [](Scenario& s) { s.simulation->UpdateEntities(TickLength); } },
+		{ "sweep_balls", 1, nullptr, [](Scenario& s) { s.simulation->SweepBalls(TickLength); } },
+		{ "handle_collisions", 1, nullptr, [](Scenario& s) { s.simulation->HandleCollisions(); } },
+		{ "handle_ball_collisions", 1, nullptr, [](Scenario& s) { s.simulation->HandleBallCollisions(); } },
+		{ "handle_wall_collisions", 1, nullptr, [](Scenario& s) { s.simulation->HandleWallCollisions(); } },
+		{ "handle_block_collisions", 1, nullptr, [](Scenario& s) { s.simulation->HandleBlockCollisions(); } },
+		{ "handle_paddle_collisions", 1, nullptr, [](Scenario& s) { s.simulation->HandlePaddleCollisions(); } },
+		{ "check_game_rules", 1, nullptr, [](Scenario& s) { s.simulation->CheckGameRules(); } },
+		{ "reset_game", 1, nullptr, [](Scenario& s) { s.simulation->ResetGame(); } },
+
+		// Every ball but the first put away by a reset, then all of them launched again from the spares
+		{ "respawn_balls", 1,
+			[](Scenario& s) { s.simulation->ResetGame(); },
+			[](Scenario& s) { s.simulation->SpawnBalls(static_cast<int>(s.state.m_Entities.Count<SpareBalls>())); } },
+
+		// Just the decision, written to the paddle so it isn't optimised out
+		{ "autoplay_lowest_ball", 1, nullptr, [](Scenario& s) {
+			Autoplayer autoplayer { 1, true, AutoplayAim::LOWEST_BALL };
+			s.state.m_Entities.directions[s.state.m_Paddle].x = autoplayer.NextInput(s.state).paddleDirection;
+			} },
+		{ "autoplay_predicted_landing", 1, nullptr, [](Scenario& s) {
+			Autoplayer autoplayer { 1, true, AutoplayAim::PREDICTED_LANDING };
+			s.state.m_Entities.directions[s.state.m_Paddle].x = autoplayer.NextInput(s.state).paddleDirection;
+			} },
+
+		// The classic respawn adds two blocks per row, start two short so it lands on the brick count
+		{ "level_clear_respawn", 1,
+			[](Scenario& s) {
+				s.state.m_GameMode = GameMode::LEVEL_CLEAR;
+				s.state.m_currentBlocksPerRow = std::max(1, s.GetBlocksPerRow() - 2);
+			},
+			[](Scenario& s) { s.simulation->Step(SimInput {}, TickLength); } },
+
+		{ "tick", 1, nullptr, [](Scenario& s) { s.simulation->Step(SimInput {}, TickLength); } },
+
+		{ "second_of_play", secondOfPlayTicks, nullptr, [](Scenario& s) {
+			Autoplayer autoplayer { 1, true };
+			for (int i { 0 }; i < secondOfPlayTicks; i++)
+			{
+				s.simulation->Step(autoplayer.NextInput(s.state), TickLength);
+			}
+			} },
+	};
+
+	BrickField level;
+	if (config.levelPath != nullptr)
+	{
+		if (!LoadLevel(config.levelPath, level) || level.IsEmpty())
+		{
+			std::fprintf(stderr, "Couldn't load level %s\n", config.levelPath);
+			return 1;
+		}
+
+		// One pass over the balls with the level's bricks
+		config.bricks = { static_cast<int>(level.GetLiveCount()) };
+	}
+
+	const double timerOverhead { MeasureTimerOverhead() };
+
+	std::vector<BenchResult> results;
+	Scenario scenario;
+	for (int bricks : config.bricks)
+	{
+		for (int balls : config.balls)
+		{
+			scenario.Setup(bricks, std::max(1, balls), config.levelPath != nullptr ? &level : nullptr);
+			const int actualBricks { config.levelPath != nullptr ? bricks : scenario.GetBlocksPerRow() * GameState::m_NumBlockRows };
+
+			for (const Benchmark& benchmark : benchmarks)
+			{
+				if (config.filter != nullptr && std::strstr(benchmark.name, config.filter) == nullptr) continue;
+
+				// Multi-tick benchmarks are steadier per sample, they don't need as many
+				const int iterations { std::clamp(config.iterations * 4 / benchmark.ticksPerIteration, 1, config.iterations) };
+				results.push_back(Run(benchmark, scenario, actualBricks, balls, iterations));
+				std::fprintf(stderr, "%-26s bricks %3d balls %4d  median %10.1f ns  dropped contacts %llu\n",
+					benchmark.name, actualBricks, balls, results.back().medianNs, static_cast<unsigned long long>(results.back().droppedBallContacts));
+			}
+		}
+	}
+
+	FILE* output { stdout };
+	if (config.outPath != nullptr)
+	{
+		output = std::fopen(config.outPath, "w");
+		if (output == nullptr)
+		{
+			std::fprintf(stderr, "Couldn't open %s for writing\n", config.outPath);
+			return 1;
+		}
+	}
+
+	std::fprintf(output, "{\n");
+	std::fprintf(output, "  \"suite\": \"breakout_bench\",\n");
+	std::fprintf(output, "  \"label\": \"%s\",\n", config.label);
+	std::fprintf(output, "  \"tick_length_s\": %.9f,\n", TickLength);
+	std::fprintf(output, "  \"seed\": %u,\n", BenchSeed);
+	std::fprintf(output, "  \"timer_overhead_ns\": %.1f,\n", timerOverhead);
+	std::fprintf(output, "  \"results\": [\n");
+	for (size_t i { 0 }; i < results.size(); i++)
+	{
+		const BenchResult& result { results[i] };
+		std::fprintf(output, "    { \"name\": \"%s\", \"bricks\": %d, \"balls\": %d, \"live_bricks\": %d, \"active_balls\": %d, "
+			"\"iterations\": %d, \"ticks_per_iteration\": %d, \"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f, \"p99_ns\": %.1f, "
+			"\"dropped_ball_contacts\": %llu }%s\n",
+			result.name.c_str(), result.bricks, result.balls, result.liveBricks, result.activeBalls,
+			result.iterations, result.ticksPerIteration, result.minNs, result.medianNs, result.meanNs, result.p99Ns,
+			static_cast<unsigned long long>(result.droppedBallContacts), i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(output, "  ]\n}\n");
+
+	if (output != stdout) std::fclose(output);
+	return 0;
+}
@@ -0,0 +1,615 @@
+#include "simulation.h"
+#include "gamestate.h"
+#include "autoplayer.h"
+#include "renderqueue.h"
+#include "gameview.h"
+#include "softwarerenderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+/*
+* Draw path benchmarks on the software render backend, so they run on machines with no GPU.
+* Each frame is recorded through RecordGameView like GameLayer::Draw records it (background,
+* brick field, paddle and balls, the pause overlay) plus the score text, and submitted to a
+* 480x360 framebuffer.
+
+* The sprites and font are generated here rather than loaded, so there's no dependency
+* on raylib's image loading or the asset archive and every run draws exactly the same
+* pixels. The hash of each benchmark's frame goes in the JSON next to its timings and is
+* checked against GoldenFrames, the bench fails if something drew differently. "record"
+* never draws, its queue_hash is of the recorded commands instead. --frames
+* writes the frames out as PPMs to look at.
+*
+* Usage: breakout_render_bench [--bricks 28,44,60] [--balls 1,16,256] [--iterations N]
+*                              [--filter name] [--label text] [--out file] [--frames prefix]
+*/
+
+struct BenchConfig
+{
+	std::vector<int> bricks { 28, 44, 60 };
+	std::vector<int> balls { 1, 16, 256 };
+	int iterations { 500 };
+	const char* filter { nullptr };
+	const char* label { "" };
+	const char* outPath { nullptr };
+	const char* framesPrefix { nullptr };
+};
+
+struct BenchResult
+{
+	std::string name;
+	int bricks;
+	int balls;
+	int commands;
+	int iterations;
+	double minNs;
+	double medianNs;
+	double meanNs;
+	double p99Ns;
+
+	// The framebuffer's hash, or the render queue's for a benchmark that only records
+	uint64_t hash;
+	bool queueHash;
+};
+
+constexpr float TickLength { 1.0f / 120.0f };
+constexpr uint32_t BenchSeed { 12345 };
+
+// A second of play so the balls have spread out and a few blocks are gone
+constexpr int WarmupTicks { 120 };
+
+// Stand-ins for the IDs raylib would have given the textures
+constexpr unsigned int AtlasTextureID { 1 };
+constexpr unsigned int FontTextureID { 2 };
+constexpr unsigned int BrickFieldTextureID { 3 };
+
+struct GoldenFrame
+{
+	const char* name;
+	int bricks;
+	int balls;
+	uint64_t hash;
+};
+
+/*
+* Known good frame hashes for the default sizes, any others aren't checked. The record rows
+* hold the render queue's hash since they never draw. The bricks are one sprite of the
+* field's cached texture there, so sizes with the same balls can share a hash. A change that
+* draws something differently on purpose updates these from the bench's output, anything
+* else that changes one is a bug.
+*/
+constexpr GoldenFrame GoldenFrames[] {
+	{ "record", 28, 1, 0x2834c47b6fcb732dull },
+	{ "submit", 28, 1, 0x0cc56009f577487dull },
+	{ "frame", 28, 1, 0x0cc56009f577487dull },
+	{ "frame_live_blocks", 28, 1, 0x0cc56009f577487dull },
+	{ "frame_paused", 28, 1, 0x296a6ae157e30999ull },
+	{ "record", 28, 16, 0xa445bb2bbe48cf71ull },
+	{ "submit", 28, 16, 0x1aa4886c008b362dull },
+	{ "frame", 28, 16, 0x1aa4886c008b362dull },
+	{ "frame_live_blocks", 28, 16, 0x1aa4886c008b362dull },
+	{ "frame_paused", 28, 16, 0x35e1eab889f45b11ull },
+	{ "record", 28, 256, 0xf0c629b3c282526eull },
+	{ "submit", 28, 256, 0xc0abf73ce6f30365ull },
+	{ "frame", 28, 256, 0xc0abf73ce6f30365ull },
+	{ "frame_live_blocks", 28, 256, 0xc0abf73ce6f30365ull },
+	{ "frame_paused", 28, 256, 0x7f74d2a2fdf19e3full },
+	{ "record", 44, 1, 0x0cf8a311c0469983ull },
+	{ "submit", 44, 1, 0xa072de2f2dc570ddull },
+	{ "frame", 44, 1, 0xa072de2f2dc570ddull },
+	{ "frame_live_blocks", 44, 1, 0xa072de2f2dc570ddull },
+	{ "frame_paused", 44, 1, 0xf493cad30fa9ed89ull },
+	{ "record", 44, 16, 0xef30ac770bd37130ull },
+	{ "submit", 44, 16, 0x0c06819c9d12465dull },
+	{ "frame", 44, 16, 0x0c06819c9d12465dull },
+	{ "frame_live_blocks", 44, 16, 0x0c06819c9d12465dull },
+	{ "frame_paused", 44, 16, 0xa621791f7d5a1ed1ull },
+	{ "record", 44, 256, 0xea84a6be54643023ull },
+	{ "submit", 44, 256, 0x027355fd2d1ee1c5ull },
+	{ "frame", 44, 256, 0x027355fd2d1ee1c5ull },
+	{ "frame_live_blocks", 44, 256, 0x027355fd2d1ee1c5ull },
+	{ "frame_paused", 44, 256, 0x8ed9ce2d91e8eccfull },
+	{ "record", 60, 1, 0x0cf8a311c0469983ull },
+	{ "submit", 60, 1, 0xe7c885163e95e59dull },
+	{ "frame", 60, 1, 0xe7c885163e95e59dull },
+	{ "frame_live_blocks", 60, 1, 0xe7c885163e95e59dull },
+	{ "frame_paused", 60, 1, 0x8e6559a59a61ba49ull },
+	{ "record", 60, 16, 0x46fb508b4b126a6full },
+	{ "submit", 60, 16, 0x8c11713582048b2dull },
+	{ "frame", 60, 16, 0x8c11713582048b2dull },
+	{ "frame_live_blocks", 60, 16, 0x8c11713582048b2dull },
+	{ "frame_paused", 60, 16, 0x7aa4e6385a9150b1ull },
+	{ "record", 60, 256, 0x807e82a3605f7fcbull },
+	{ "submit", 60, 256, 0x40d8759b780dc07dull },
+	{ "frame", 60, 256, 0x40d8759b780dc07dull },
+	{ "frame_live_blocks", 60, 256, 0x40d8759b780dc07dull },
+	{ "frame_paused", 60, 256, 0x65e9d5de0baf5980ull },
+};
+
+static const GoldenFrame* FindGoldenFrame(const BenchResult& result)
+{
+	for (const GoldenFrame& golden : GoldenFrames)
+	{
+		if (result.name == golden.name && result.bricks == golden.bricks && result.balls == golden.balls) return &golden;
+	}
+	return nullptr;
+}
+
+static std::vector<int> ParseList(const char* text)
+{
+	std::vector<int> values;
+	const char* item { text };
+	while (*item != '\0')
+	{
+		char* end { nullptr };
+		const long value { std::strtol(item, &end, 10) };
+		if (end == item) break;
+
+		values.push_back(static_cast<int>(value));
+		item = *end == ',' ? end + 1 : end;
+	}
+	return values;
+}
+
+/*
+* A sprite atlas and an 8px bitmap font made of plain shapes, sized like the game's real
+* assets. The ball is round and the glyphs have soft edges so the transparent and partly
+* transparent blending paths get used, not just opaque copies.
+*/
+class BenchAssets
+{
+private:
+	std::vector<Rectangle> m_Sources;
+	std::vector<Color> m_AtlasPixels;
+	std::vector<Color> m_FontPixels;
+	std::vector<GlyphInfo> m_Glyphs;
+	std::vector<Rectangle> m_Recs;
+
+	SpriteID AddSprite(std::vector<Color>& pixels, int atlasWidth, int x, int width, int height, auto&& shade)
+	{
+		for (int py { 0 }; py < height; py++)
+		{
+			for (int px { 0 }; px < width; px++)
+			{
+				pixels[static_cast<size_t>(py) * static_cast<size_t>(atlasWidth) + static_cast<size_t>(x + px)] = shade(px, py);
+			}
+		}
+
+		m_Sources.push_back({ static_cast<float>(x), 0.0f, static_cast<float>(width), static_cast<float>(height) });
+		return static_cast<SpriteID>(m_Sources.size() - 1);
+	}
+
+public:
+	SimLayout layout;
+	SpriteID brickSpriteIDs[GameState::m_NumBlockRows] { 0 };
+	Font font { 0 };
+
+	static constexpr int m_AtlasWidth { 256 };
+	static constexpr int m_AtlasHeight { 16 };
+	static constexpr int m_GlyphCell { 8 };
+	static constexpr int m_FontColumns { 16 };
+	static constexpr int m_FirstGlyph { ' ' };
+	static constexpr int m_GlyphCount { '~' - ' ' + 1 };
+	static constexpr int m_FontWidth { m_FontColumns * m_GlyphCell };
+	static constexpr int m_FontHeight { (m_GlyphCount + m_FontColumns - 1) / m_FontColumns * m_GlyphCell };
+
+	void Build()
+	{
+		constexpr int atlasWidth { m_AtlasWidth };
+		std::vector<Color>& atlas { m_AtlasPixels };
+		atlas.assign(m_AtlasWidth * m_AtlasHeight, BLANK);
+		m_Sources.clear();
+
+		int x { 0 };
+		auto Bordered { [](Color fill, int width, int height) {
+			return [=](int px, int py) {
+				const bool edge { px == 0 || py == 0 || px == width - 1 || py == height - 1 };
+				return edge ? Color { static_cast<unsigned char>(fill.r / 2), static_cast<unsigned char>(fill.g / 2), static_cast<unsigned char>(fill.b / 2), 255 } : fill;
+				};
+			} };
+
+		layout.paddleSpriteID = AddSprite(atlas, atlasWidth, x, layout.paddleWidth, layout.paddleHeight,
+			Bordered(Color { 200, 200, 210, 255 }, layout.paddleWidth, layout.paddleHeight));
+		x += layout.paddleWidth;
+
+		layout.ballSpriteID = AddSprite(atlas, atlasWidth, x, layout.ballWidth, layout.ballHeight, [&](int px, int py) {
+			const float dx { static_cast<float>(px) + 0.5f - layout.ballWidth * 0.5f };
+			const float dy { static_cast<float>(py) + 0.5f - layout.ballHeight * 0.5f };
+			const bool inside { dx * dx + dy * dy <= layout.ballWidth * layout.ballWidth * 0.25f };
+			return inside ? Color { 240, 240, 240, 255 } : BLANK;
+			});
+		x += layout.ballWidth;
+
+		constexpr Color blockColours[GameState::m_NumBlockRows] {
+			{ 70, 110, 220, 255 }, { 150, 95, 60, 255 }, { 80, 180, 90, 255 }, { 220, 110, 170, 255 }
+		};
+		for (int row { 0 }; row < GameState::m_NumBlockRows; row++)
+		{
+			brickSpriteIDs[row] = AddSprite(atlas, atlasWidth, x, layout.blockWidth, layout.blockHeight,
+				Bordered(blockColours[row], layout.blockWidth, layout.blockHeight));
+			x += layout.blockWidth;
+		}
+
+		BuildFont();
+	}
+
+	// Printable ASCII in a 16 column grid, each glyph a scrambled pattern with half alpha edges
+	void BuildFont()
+	{
+		constexpr int cell { m_GlyphCell };
+		constexpr int columns { m_FontColumns };
+		constexpr int first { m_FirstGlyph };
+		constexpr int count { m_GlyphCount };
+		constexpr int fontWidth { m_FontWidth };
+		std::vector<Color>& pixels { m_FontPixels };
+		pixels.assign(m_FontWidth * m_FontHeight, BLANK);
+
+		m_Glyphs.resize(count);
+		m_Recs.resize(count);
+		for (int i { 0 }; i < count; i++)
+		{
+			const int cellX { i % columns * cell };
+			const int cellY { i / columns * cell };
+			uint32_t bits { static_cast<uint32_t>(first + i) * 2654435761u };
+
+			// 6x7 inside the cell, with a column and row free for the spacing
+			for (int py { 0 }; py < cell - 1; py++)
+			{
+				for (int px { 0 }; px < cell - 2; px++)
+				{
+					bits = bits * 1664525u + 1013904223u;
+					const bool edge { px == 0 || px == cell - 3 };
+					const unsigned char alpha { (bits >> 28) < 7 ? static_cast<unsigned char>(edge ? 128 : 255) : static_cast<unsigned char>(0) };
+					pixels[static_cast<size_t>(cellY + py) * fontWidth + static_cast<size_t>(cellX + px)] = Color { 255, 255, 255, alpha };
+				}
+			}
+
+			m_Glyphs[i] = GlyphInfo { first + i, 0, 0, cell - 1, Image { 0 } };
+			m_Recs[i] = Rectangle { static_cast<float>(cellX), static_cast<float>(cellY), static_cast<float>(cell - 2), static_cast<float>(cell - 1) };
+		}
+
+		font.baseSize = cell;
+		font.glyphCount = count;
+		font.glyphPadding = 0;
+		font.texture = Texture2D { FontTextureID, m_FontWidth, m_FontHeight, 1, 0 };
+		font.recs = m_Recs.data();
+		font.glyphs = m_Glyphs.data();
+	}
+
+	// What loading the textures would be in the game
+	void Upload(SoftwareRenderBackend& backend) const
+	{
+		backend.SetTexture(AtlasTextureID, m_AtlasWidth, m_AtlasHeight, m_AtlasPixels);
+		backend.SetTexture(FontTextureID, m_FontWidth, m_FontHeight, m_FontPixels);
+	}
+
+	inline const Rectangle& GetSource(SpriteID sprite) const
+	{
+		return m_Sources[sprite];
+	}
+
+	inline std::span<const Rectangle> GetSources() const
+	{
+		return m_Sources;
+	}
+};
+
+struct FrameOptions
+{
+	// Bricks from the one brick field texture like BrickFieldCache, otherwise a sprite each
+	bool cachedBlocks { true };
+	bool paused { false };
+};
+
+/*
+* A round some way in with the given numbers of bricks and balls. Nothing steps while it's
+* drawn, so unlike breakout_bench there's no snapshot to restore between samples.
+*/
+class Scenario
+{
+private:
+	int m_BlocksPerRow { 0 };
+
+public:
+	GameState state;
+	BenchAssets assets;
+	SoftwareRenderBackend backend;
+	RenderQueue queue;
+
+	void Setup(int bricks, int balls)
+	{
+		m_BlocksPerRow = std::clamp(bricks / GameState::m_NumBlockRows, 1, GameState::m_MaxBlocksPerRow);
+
+		assets.Build();
+		backend = SoftwareRenderBackend {};
+		assets.Upload(backend);
+		queue.SetShapesTexture(Texture2D { AtlasTextureID, 0, 0, 1, 0 });
+
+		Simulation simulation { state };
+		simulation.Init(assets.layout, BenchSeed);
+		simulation.ResetGame();
+
+		// ResetGame always starts from the first level's row, a level clear respawns the field
+		// at the size we want. The bricks are put straight in place instead of dropping in
+		state.m_currentBlocksPerRow = std::max(1, m_BlocksPerRow - 2);
+		state.m_GameMode = GameMode::LEVEL_CLEAR;
+		simulation.Step(SimInput {}, 0.0f);
+		state.m_Bricks.SetOffsetY(0.0f);
+		state.m_Bricks.SnapPreviousOffset();
+
+		simulation.SpawnBalls(balls - 1);
+
+		Autoplayer autoplayer { balls, true };
+		for (int i { 0 }; i < WarmupTicks; i++)
+		{
+			simulation.Step(autoplayer.NextInput(state), TickLength);
+		}
+
+		BakeBrickField();
+	}
+
+	// What BrickFieldCache draws into its render texture, done with a framebuffer of its own
+	void BakeBrickField()
+	{
+		SoftwareRenderBackend brickField;
+		assets.Upload(brickField);
+
+		const BrickField& bricks { state.m_Bricks };
+		const Texture2D atlas { AtlasTextureID, 0, 0, 1, 0 };
+		bricks.ForEachLive([&](int column, int row, BrickCell cell) {
+			const Rectangle& source { assets.GetSource(assets.brickSpriteIDs[cell.type % GameState::m_NumBlockRows]) };
+			const Rectangle bounds { bricks.GetCellBounds(column, row) };
+			brickField.DrawSprite(atlas, source, { std::trunc(bounds.x), std::trunc(bounds.y), std::ceil(bounds.width), std::ceil(bounds.height) }, WHITE);
+			});
+
+		// Stored upside down like a render texture is, RecordGameView flips it back
+		const std::span<const Color> pixels { brickField.GetPixels() };
+		const size_t width { static_cast<size_t>(brickField.GetWidth()) };
+		std::vector<Color> flipped(pixels.size());
+		for (size_t row { 0 }; row < pixels.size() / width; row++)
+		{
+			std::copy_n(pixels.begin() + static_cast<std::ptrdiff_t>(row * width), width, flipped.end() - static_cast<std::ptrdiff_t>((row + 1) * width));
+		}
+		backend.SetTexture(BrickFieldTextureID, brickField.GetWidth(), brickField.GetHeight(), flipped);
+	}
+
+	// Every glyph in the bench font has the same advance, so measuring is just counting
+	void PushCentredText(RenderLayer layer, const char* text, float y, float fontSize)
+	{
+		constexpr float spacing { 2.0f };
+		const Font& font { assets.font };
+		const float advance { static_cast<float>(font.glyphs[0].advanceX) * fontSize / static_cast<float>(font.baseSize) + spacing };
+		const float width { static_cast<float>(std::strlen(text)) * advance - spacing };
+		queue.PushText(layer, font, text, { (GameResolution::f_Width - width) * 0.5f, y }, fontSize, spacing, WHITE);
+	}
+
+	// The frame GameLayer::Draw records, with the bench font's text in place of the game's UIText
+	void RecordFrame(const FrameOptions& options)
+	{
+		const GameView view { state.m_Entities, state.m_Bricks, options.paused ? GameMode::PAUSED : state.m_GameMode, state.m_Score, state.m_HighScore };
+
+		GameViewSprites sprites;
+		sprites.atlas = Texture2D { AtlasTextureID, 0, 0, 1, 0 };
+		sprites.sources = assets.GetSources();
+		sprites.brickSprites = assets.brickSpriteIDs;
+		if (options.cachedBlocks)
+		{
+			sprites.brickField = Texture2D { BrickFieldTextureID, GameResolution::width, GameResolution::height, 1, 0 };
+		}
+
+		queue.Begin();
+		RecordGameView(queue, view, sprites, 0.5f);
+
+		char score[16];
+		std::snprintf(score, sizeof(score), "%d", view.score);
+		PushCentredText(RENDER_LAYER_HUD, score, 7.0f, 16);
+
+		if (view.gameMode == GameMode::PAUSED)
+		{
+			PushCentredText(RENDER_LAYER_UI_TEXT, "ready?", 150.0f, 22);
+			PushCentredText(RENDER_LAYER_UI_TEXT, "press space or enter to start", 182.0f, 12);
+		}
+	}
+
+	inline int GetBlocksPerRow() const
+	{
+		return m_BlocksPerRow;
+	}
+};
+
+struct Benchmark
+{
+	const char* name;
+	FrameOptions options;
+
+	// Runs untimed before each sample
+	std::function<void(Scenario&, const FrameOptions&)> prepare;
+	std::function<void(Scenario&, const FrameOptions&)> run;
+
+	// Nothing reaches the framebuffer, the recorded commands are hashed instead
+	bool recordOnly { false };
+};
+
+static double Nanoseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+static BenchResult Run(const Benchmark& benchmark, Scenario& scenario, int bricks, int balls, int iterations)
+{
+	std::vector<double> samples(static_cast<size_t>(iterations));
+	for (double& sample : samples)
+	{
+		if (benchmark.prepare) benchmark.prepare(scenario, benchmark.options);
+
+		const auto start { std::chrono::steady_clock::now() };
+		benchmark.run(scenario, benchmark.options);
+		const auto end { std::chrono::steady_clock::now() };
+		sample = Nanoseconds(start, end);
+	}
+
+	std::sort(samples.begin(), samples.end());
+	double total { 0.0 };
+	for (double sample : samples) total += sample;
+
+	BenchResult result;
+	result.name = benchmark.name;
+	result.bricks = bricks;
+	result.balls = balls;
+	result.commands = static_cast<int>(scenario.queue.GetCommandCount());
+	result.iterations = iterations;
+	result.minNs = samples.front();
+	result.medianNs = samples[samples.size() / 2];
+	result.meanNs = total / static_cast<double>(samples.size());
+	result.p99Ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+	result.queueHash = benchmark.recordOnly;
+	result.hash = benchmark.recordOnly ? scenario.queue.GetHash() : scenario.backend.GetHash();
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	BenchConfig config;
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bricks") == 0 && i + 1 < argc)
+		{
+			config.bricks = ParseList(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+		{
+			config.balls = ParseList(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+		{
+			config.iterations = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+		{
+			config.filter = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--label") == 0 && i + 1 < argc)
+		{
+			config.label = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+		{
+			config.outPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			config.framesPrefix = argv[++i];
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--bricks 28,44,60] [--balls 1,16,256] [--iterations N] [--filter name] [--label text] [--out file] [--frames prefix]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	auto Record { [](Scenario& s, const FrameOptions& options) { s.RecordFrame(options); } };
+	auto Submit { [](Scenario& s, const FrameOptions&) { s.queue.Submit(s.backend); } };
+	auto Frame { [](Scenario& s, const FrameOptions& options) {
+		s.backend.Clear(Color { 28, 28, 28, 255 });
+		s.RecordFrame(options);
+		s.queue.Submit(s.backend);
+		} };
+
+	// Submit sorts the keys in place, so the submit only benchmark records a fresh frame before each sample
+	const std::vector<Benchmark> benchmarks {
+		{ "record", {}, nullptr, Record, true },
+		{ "submit", {}, Record, Submit },
+		{ "frame", {}, nullptr, Frame },
+		{ "frame_live_blocks", { false, false }, nullptr, Frame },
+		{ "frame_paused", { true, true }, nullptr, Frame },
+	};
+
+	std::vector<BenchResult> results;
+	int mismatches { 0 };
+	Scenario scenario;
+	for (int bricks : config.bricks)
+	{
+		for (int balls : config.balls)
+		{
+			scenario.Setup(bricks, std::max(1, balls));
+			const int actualBricks { scenario.GetBlocksPerRow() * GameState::m_NumBlockRows };
+
+			for (const Benchmark& benchmark : benchmarks)
+			{
+				if (config.filter != nullptr && std::strstr(benchmark.name, config.filter) == nullptr) continue;
+
+				// Each one starts from the same cleared framebuffer so the hashes only depend on what it draws
+				scenario.backend.Clear(Color { 28, 28, 28, 255 });
+				results.push_back(Run(benchmark, scenario, actualBricks, balls, config.iterations));
+				std::fprintf(stderr, "%-18s bricks %3d balls %4d  median %10.1f ns  hash %016llx\n",
+					benchmark.name, actualBricks, balls, results.back().medianNs, static_cast<unsigned long long>(results.back().hash));
+
+				const GoldenFrame* golden { FindGoldenFrame(results.back()) };
+				if (golden != nullptr && golden->hash != results.back().hash)
+				{
+					std::fprintf(stderr, "%-18s bricks %3d balls %4d  expected hash %016llx\n",
+						benchmark.name, actualBricks, balls, static_cast<unsigned long long>(golden->hash));
+					mismatches++;
+				}
+
+				if (config.framesPrefix != nullptr)
+				{
+					const std::string path { std::string { config.framesPrefix } + "_" + benchmark.name + "_" +
+						std::to_string(actualBricks) + "_" + std::to_string(balls) + ".ppm" };
+					if (!scenario.backend.WritePPM(path.c_str()))
+					{
+						std::fprintf(stderr, "Couldn't write %s\n", path.c_str());
+					}
+				}
+			}
+		}
+	}
+
+	FILE* output { stdout };
+	if (config.outPath != nullptr)
+	{
+		output = std::fopen(config.outPath, "w");
+		if (output == nullptr)
+		{
+			std::fprintf(stderr, "Couldn't open %s for writing\n", config.outPath);
+			return 1;
+		}
+	}
+
+	std::fprintf(output, "{\n");
+	std::fprintf(output, "  \"suite\": \"render_bench\",\n");
+	std::fprintf(output, "  \"label\": \"%s\",\n", config.label);
+	std::fprintf(output, "  \"blitter\": \"%s\",\n", SoftwareBlitImplementation());
+	std::fprintf(output, "  \"width\": %d,\n", GameResolution::width);
+	std::fprintf(output, "  \"height\": %d,\n", GameResolution::height);
+	std::fprintf(output, "  \"seed\": %u,\n", BenchSeed);
+	std::fprintf(output, "  \"results\": [\n");
+	for (size_t i { 0 }; i < results.size(); i++)
+	{
+		const BenchResult& result { results[i] };
+		std::fprintf(output, "    { \"name\": \"%s\", \"bricks\": %d, \"balls\": %d, \"commands\": %d, \"iterations\": %d, "
+			"\"min_ns\": %.1f, \"median_ns\": %.1f, \"mean_ns\": %.1f, \"p99_ns\": %.1f, \"%s\": \"%016llx\" }%s\n",
+			result.name.c_str(), result.bricks, result.balls, result.commands, result.iterations,
+			result.minNs, result.medianNs, result.meanNs, result.p99Ns,
+			result.queueHash ? "queue_hash" : "frame_hash", static_cast<unsigned long long>(result.hash),
+			i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(output, "  ]\n}\n");
+
+	if (output != stdout) std::fclose(output);
+
+	if (mismatches > 0)
+	{
+		std::fprintf(stderr, "%d frames didn't match their golden hash\n", mismatches);
+		return 1;
+	}
+	return 0;
+}
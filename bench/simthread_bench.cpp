@@ -0,0 +1,209 @@
+#include "simthread.h"
+#include "simulation.h"
+#include "gamestate.h"
+#include "autoplayer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct TimingResult
+{
+	long long ticks { 0 };
+	long long frames { 0 };
+	long long freshFrames { 0 };
+	std::vector<double> intervals;
+};
+
+struct BenchOptions
+{
+	double seconds { 5.0 };
+	float tickRate { 120.0f };
+	int numBalls { 64 };
+	double frameMilliseconds { 1000.0 / 60.0 };
+	double stallMilliseconds { 100.0 };
+	int stallEvery { 30 };
+};
+
+// A frame's worth of time, with a long stall every few frames like a texture upload or a vsync miss
+static void WaitFrame(const BenchOptions& options, long long frame)
+{
+	const double milliseconds { frame % options.stallEvery == options.stallEvery - 1 ? options.stallMilliseconds : options.frameMilliseconds };
+	std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(milliseconds));
+}
+
+static void RecordTick(TimingResult& result, Clock::time_point& lastTick)
+{
+	const Clock::time_point now { Clock::now() };
+	if (result.ticks > 0)
+	{
+		result.intervals.push_back(std::chrono::duration<double, std::milli>(now - lastTick).count());
+	}
+	lastTick = now;
+	result.ticks++;
+}
+
+// The same loop as Application::Run in FIXED mode, ticks only run when the frame gets round to them
+static TimingResult RunSerial(const BenchOptions& options)
+{
+	GameState gameState;
+	Simulation simulation { gameState };
+	simulation.Init(SimLayout {}, 1);
+	Autoplayer autoplayer { options.numBalls };
+
+	const float tickLength { 1.0f / options.tickRate };
+	constexpr int maxCatchUpSteps { 8 };
+	TimingResult result;
+	Clock::time_point lastTick;
+	float accumulator { 0.0f };
+
+	const Clock::time_point startTime { Clock::now() };
+	Clock::time_point frameStart { startTime };
+	while (Clock::now() - startTime < std::chrono::duration<double>(options.seconds))
+	{
+		const Clock::time_point now { Clock::now() };
+		accumulator += std::chrono::duration<float>(now - frameStart).count();
+		frameStart = now;
+
+		int steps { 0 };
+		while (accumulator >= tickLength && steps < maxCatchUpSteps)
+		{
+			simulation.Step(autoplayer.NextInput(gameState), tickLength);
+			RecordTick(result, lastTick);
+			accumulator -= tickLength;
+			steps++;
+		}
+		accumulator = std::fmod(accumulator, tickLength);
+
+		result.frames++;
+		result.freshFrames += steps > 0;
+		WaitFrame(options, result.frames);
+	}
+	return result;
+}
+
+static TimingResult RunThreaded(const BenchOptions& options, bool& snapshotsInOrder)
+{
+	GameState gameState;
+	Simulation simulation { gameState };
+	simulation.Init(SimLayout {}, 1);
+	Autoplayer autoplayer { options.numBalls };
+
+	// Only the sim thread touches these until Stop
+	TimingResult result;
+	Clock::time_point lastTick;
+	result.intervals.reserve(static_cast<size_t>(options.seconds * options.tickRate * 2.0));
+
+	SimThread simThread;
+	simThread.Start(gameState, 1.0f / options.tickRate, [&](const SimInput&, float deltaTime) {
+		const uint8_t events { simulation.Step(autoplayer.NextInput(gameState), deltaTime) };
+		RecordTick(result, lastTick);
+		return events;
+		});
+
+	long long frames { 0 };
+	long long freshFrames { 0 };
+	uint64_t lastSnapshotTick { 0 };
+	snapshotsInOrder = true;
+
+	const Clock::time_point startTime { Clock::now() };
+	while (Clock::now() - startTime < std::chrono::duration<double>(options.seconds))
+	{
+		if (simThread.AcquireSnapshot())
+		{
+			freshFrames++;
+		}
+
+		const SimSnapshot& snapshot { simThread.GetSnapshot() };
+		snapshotsInOrder &= snapshot.tick >= lastSnapshotTick && snapshot.entities.positions.size() == snapshot.entities.Size();
+		lastSnapshotTick = snapshot.tick;
+		simThread.TakeEvents();
+
+		frames++;
+		WaitFrame(options, frames);
+	}
+
+	simThread.Stop();
+	result.frames = frames;
+	result.freshFrames = freshFrames;
+	return result;
+}
+
+static void PrintResult(const char* name, TimingResult& result, double seconds)
+{
+	std::vector<double>& intervals { result.intervals };
+	std::sort(intervals.begin(), intervals.end());
+	auto Percentile { [&](double percentile) {
+		return intervals.empty() ? 0.0 : intervals[std::min(intervals.size() - 1, static_cast<size_t>(percentile * intervals.size()))];
+		} };
+
+	std::printf("%-10s %9.1f %9lld %9lld %9.2f %9.2f %9.2f %9.2f\n", name, result.ticks / seconds, result.frames, result.freshFrames,
+		Percentile(0.01), Percentile(0.5), Percentile(0.99), intervals.empty() ? 0.0 : intervals.back());
+}
+
+/*
+* Runs the simulation at a fixed tick rate next to a fake render loop that stalls every
+* few frames, once stepped from the frame loop like Application does and once on a
+* SimThread, and reports how evenly the ticks were spaced. Serially a stall holds the
+* ticks back and then runs them in a burst (or drops them past the catch up limit),
+* on the thread they should stay a tick apart whatever the frames are doing.
+*
+* Usage: breakout_simthread_bench [--seconds S] [--hz H] [--balls B] [--stall MS] [--every FRAMES]
+*/
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+		{
+			options.seconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+		{
+			options.tickRate = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+		{
+			options.numBalls = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--stall") == 0 && i + 1 < argc)
+		{
+			options.stallMilliseconds = std::atof(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--every") == 0 && i + 1 < argc)
+		{
+			options.stallEvery = std::max(1, std::atoi(argv[++i]));
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--seconds S] [--hz H] [--balls B] [--stall MS] [--every FRAMES]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::printf("%.0f Hz ticks, %d balls, %.0f ms frames with a %.0f ms stall every %d, %.1f s each\n", options.tickRate, options.numBalls,
+		options.frameMilliseconds, options.stallMilliseconds, options.stallEvery, options.seconds);
+	std::printf("%-10s %9s %9s %9s %9s %9s %9s %9s\n", "", "ticks/s", "frames", "fresh", "p1 ms", "p50 ms", "p99 ms", "max ms");
+
+	TimingResult serial { RunSerial(options) };
+	PrintResult("serial", serial, options.seconds);
+
+	bool snapshotsInOrder { false };
+	TimingResult threaded { RunThreaded(options, snapshotsInOrder) };
+	PrintResult("threaded", threaded, options.seconds);
+
+	if (!snapshotsInOrder)
+	{
+		std::fprintf(stderr, "snapshot check failed, a frame saw an older or torn snapshot\n");
+		return 1;
+	}
+
+	return 0;
+}
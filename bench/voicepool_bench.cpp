@@ -0,0 +1,92 @@
+#include "audio.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+/*
+* Runs the voice pool against the null backend, checks the stealing rules and then times
+* Play with brick hits landing on a random third of the ticks like a busy multi-ball round.
+* Also counts how many of those hits the old "skip it if the sound is still playing" rule
+* would have dropped.
+*
+* Usage: breakout_voicepool_bench [--plays N]
+*/
+int main(int argc, char** argv)
+{
+	long long plays { 10'000'000 };
+	if (argc == 3 && std::strcmp(argv[1], "--plays") == 0)
+	{
+		plays = std::atoll(argv[2]);
+	}
+
+	constexpr float pitches[] { 0.95f, 0.975f, 1.0f, 1.025f, 1.05f };
+	constexpr uint32_t voiceCount { 8 };
+	constexpr double tickLength { 1.0 / 120.0 };
+
+	// 150ms of 44.1kHz mono, only the length matters to the null backend
+	const Wave brickWave { 6615, 44100, 16, 1, nullptr };
+
+	{
+		Audio::NullBackend backend;
+		Audio::VoicePool pool { backend };
+		const Audio::EffectID brick { pool.AddEffect(brickWave, pitches, voiceCount) };
+
+		for (uint32_t i { 0 }; i < voiceCount; i++)
+		{
+			pool.Play(brick);
+		}
+		const bool filledWithoutStealing { pool.GetStats().steals == 0 };
+
+		pool.Play(brick);
+		const bool stoleWhenFull { pool.GetStats().steals == 1 };
+
+		backend.Advance(1.0);
+		pool.Play(brick);
+		const bool freedAfterFinishing { pool.GetStats().steals == 1 };
+
+		if (!filledWithoutStealing || !stoleWhenFull || !freedAfterFinishing)
+		{
+			std::fprintf(stderr, "voice stealing check failed (%d %d %d)\n", filledWithoutStealing, stoleWhenFull, freedAfterFinishing);
+			return 1;
+		}
+	}
+
+	Audio::NullBackend backend;
+	Audio::VoicePool pool { backend };
+	const Audio::EffectID brick { pool.AddEffect(brickWave, pitches, voiceCount) };
+
+	// The shortest variant, the most generous case for the old rule
+	const double brickLength { static_cast<double>(brickWave.frameCount) / brickWave.sampleRate / pitches[4] };
+	double oldBusyUntil { 0.0 };
+	long long oldDropped { 0 };
+	double time { 0.0 };
+	Random random;
+
+	const auto startTime { std::chrono::steady_clock::now() };
+	for (long long i { 0 }; i < plays; )
+	{
+		if (random.Next() % 3 == 0)
+		{
+			pool.Play(brick);
+			i++;
+
+			if (time < oldBusyUntil) oldDropped++;
+			else oldBusyUntil = time + brickLength;
+		}
+
+		backend.Advance(tickLength);
+		time += tickLength;
+	}
+	const auto endTime { std::chrono::steady_clock::now() };
+
+	const double nanoseconds { std::chrono::duration<double, std::nano>(endTime - startTime).count() };
+	const Audio::VoicePoolStats& stats { pool.GetStats() };
+	std::printf("%lld plays, %u voices, %zu pitch variants\n", plays, voiceCount, std::size(pitches));
+	std::printf("%-24s %8.2f ns/play\n", "Play + tick", nanoseconds / plays);
+	std::printf("%-24s %8.1f %%\n", "voices stolen", 100.0 * stats.steals / stats.plays);
+	std::printf("%-24s %8.1f %%\n", "dropped by old rule", 100.0 * oldDropped / plays);
+
+	return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "raylib.h"
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Batched AABB overlap test, one box against up to 32 boxes packed as separate
+* min/max arrays. Bit i of the result is set when box i overlaps, using the same
+* strict comparisons as CheckCollisionAABB so touching boxes don't count.
+
+* Uses AVX2 (8 boxes at a time) when built with BREAKOUT_ENABLE_AVX2, SSE2 (4 at a time)
+* on any other x86-64 build and a plain scalar loop everywhere else (e.g. the web build).
+* An empty slot can be encoded as minX = +inf, maxX = -inf which never overlaps anything.
+
+* BrickField::ForEachTouchingBrick runs it over a chunk row of bricks at a time.
+*/
+uint32_t OverlapMaskAABB(const Rectangle& box, const float* minX, const float* minY,
+	const float* maxX, const float* maxY, size_t count);
+
+// Scalar reference version, always available so the SIMD paths can be checked and benchmarked against it
+uint32_t OverlapMaskAABBScalar(const Rectangle& box, const float* minX, const float* minY,
+	const float* maxX, const float* maxY, size_t count);
+
+// Which implementation OverlapMaskAABB was compiled with ("avx2", "sse2" or "scalar")
+const char* OverlapMaskAABBImplementation();
\ No newline at end of file
@@ -1,33 +1,127 @@
 #pragma once
 
 #include <vector>
+#include <chrono>
 #include "layer.h"
+#include <future>
 #include <memory>
 #include <type_traits>
+#include <utility>
+
+enum class TimestepMode
+{
+	VARIABLE,
+	FIXED
+};
 
 class Application {
 private:
 	std::vector<std::unique_ptr<Layer>> m_layerStack;
+	std::vector<const Layer*> m_PendingPops;
+	// For reporting the time to first frame
+	std::chrono::steady_clock::time_point m_StartTime { std::chrono::steady_clock::now() };
+	bool m_FirstFrameDrawn { false };
+
+	TimestepMode m_TimestepMode { TimestepMode::VARIABLE };
+	float m_FixedDeltaTime { 1.0f / 120.0f };
+	int m_MaxCatchUpSteps { 8 };
+	float m_Accumulator { 0.0f };
+
+	// The transition in progress, see TransitionLayer
+	struct Transition
+	{
+		const Layer* fromLayer { nullptr };
+		float fadeSeconds { 0.0f };
+		std::future<std::unique_ptr<Layer>> constructing;
+		std::unique_ptr<Layer> incoming;
+
+		// The incoming layer has loaded and the swap is waiting on this frame to be captured (see CaptureFade)
+		bool captureFade { false };
+		bool fadeCaptured { false };
+	};
+
+	std::unique_ptr<Transition> m_Transition;
+
+	// After a swap, the outgoing layer's last frame drawn over the incoming layer as it fades out
+	Texture2D m_FadeTexture { 0 };
+	const Layer* m_FadeLayer { nullptr };
+	float m_FadeDuration { 0.0f };
+	float m_FadeTime { 0.0f };
 
 	Application();
 	~Application();
 
+	void SetIcon();
 	void ProcessInput();
 	void Update(float deltaTime);
-	void Draw();
+	void Draw(float interpolationAlpha);
+	void ApplyPendingPops();
+
+	bool BeginTransition(const Layer* fromLayer, float fadeSeconds, std::future<std::unique_ptr<Layer>> constructing);
+	void UpdateTransition();
+	void SwapTransition();
+	void CaptureFade();
+	void DrawFade(float frameTime);
 public:
 	static Application& Instance();
 	void Run();
 
-	template<typename TLayer>
+	/*
+	* Steps the layers at a fixed rate, independent of the frame rate. When a frame takes
+	* longer than maxCatchUpSteps ticks the rest of the backlog is dropped, so one big
+	* hitch slows the game down rather than making it spiral.
+	*/
+	void SetFixedTimestep(float tickRate, int maxCatchUpSteps = 8);
+	void SetVariableTimestep();
+
+	template<typename TLayer, typename... TArgs>
 	requires(std::is_base_of_v<Layer, TLayer>)
-	void PushLayer()
+	TLayer& PushLayer(TArgs&&... args)
 	{
-		m_layerStack.push_back(std::make_unique<TLayer>());
+		std::unique_ptr<TLayer> layer { std::make_unique<TLayer>(std::forward<TArgs>(args)...) };
+		TLayer& layerRef { *layer };
+		m_layerStack.push_back(std::move(layer));
+		return layerRef;
 	}
 
-	void TransitionLayer(std::unique_ptr<Layer> toLayer)
+	// Removes the layer at the start of the next frame, so it is safe to call from the layer itself
+	void PopLayer(const Layer* layer);
+
+	// Milliseconds since the application was created
+	double GetElapsedMilliseconds() const;
+
+	/*
+	* Replaces fromLayer with a new TLayer without a frame ever waiting on it. The layer is
+	* constructed on a background thread while everything keeps running, then its
+	* ContinueLoading is called once a frame until it reports it has loaded. At the start
+	* of the next frame (the one after with a fade) it takes fromLayer's place in the stack
+	* and fromLayer is destroyed.
+
+	* With fadeSeconds > 0 the last frame presented before the swap is kept in a texture and
+	* faded out over the incoming layer. A null fromLayer pushes the new layer on top once it
+	* has loaded.
+
+	* The arguments are copied to the loading thread (std::ref for anything that must not be)
+	* and TLayer's constructor must not touch GL, which only works from the main thread.
+	* Only one transition runs at a time, returns false if one is already underway.
+	*/
+	template<typename TLayer, typename... TArgs>
+	requires(std::is_base_of_v<Layer, TLayer>)
+	bool TransitionLayer(const Layer* fromLayer, float fadeSeconds, TArgs&&... args)
 	{
-		// TODO:: Not sure how to handle this yet
+		if (m_Transition) return false;
+
+		auto construct { [...args = std::forward<TArgs>(args)]() mutable -> std::unique_ptr<Layer> {
+			return std::make_unique<TLayer>(std::move(args)...);
+			} };
+		return BeginTransition(fromLayer, fadeSeconds, std::async(std::launch::async, std::move(construct)));
 	}
+
+	inline bool IsTransitioning() const
+	{
+		return m_Transition != nullptr;
+	}
+
+	// 0-1 for the layer being transitioned in (0 while it's still being constructed), 1 with no transition
+	float GetTransitionProgress() const;
 };
\ No newline at end of file
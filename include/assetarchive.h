@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+
+/*
+* Layout of assets.pak, written by tools/assetbaker.cpp at build time and memory mapped
+* by the AssetLoader at runtime. Everything is already decoded so loading is just
+* pointing raylib at the mapped bytes:
+
+*	ArchiveHeader
+*	ArchiveEntry[entryCount]
+*	data, every entry's data starts on a 16 byte boundary
+
+* IMAGE data is the pixels in the entry's pixel format (the baker always writes RGBA8).
+* WAVE data is the PCM samples as raylib's Wave stores them.
+* FONT data is ArchiveGlyph[glyphCount] followed by the glyph atlas pixels. Fonts are
+* rasterised at ArchiveFontSize with ArchiveFontGlyphCount glyphs, the size the game uses.
+
+* Plain little endian structs, the archive is only ever read by the build that baked it.
+* Opening it checks every entry's size against its fields, one that's off and the whole
+* archive is skipped for the loose files the same as a bad header.
+*/
+constexpr uint32_t ArchiveMagic { 0x4B415042 }; // "BPAK"
+constexpr uint32_t ArchiveVersion { 1 };
+constexpr uint64_t ArchiveAlignment { 16 };
+
+constexpr int ArchiveFontSize { 32 };
+constexpr int ArchiveFontGlyphCount { 250 };
+
+enum ArchiveEntryType : uint32_t
+{
+	ARCHIVE_ENTRY_IMAGE = 0,
+	ARCHIVE_ENTRY_WAVE,
+	ARCHIVE_ENTRY_FONT
+};
+
+struct ArchiveHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+};
+
+struct ArchiveEntry
+{
+	// Path relative to assets/ with forward slashes, e.g. "image/paddle.png"
+	char name[64];
+	uint32_t type;
+
+	// IMAGE and FONT (the glyph atlas)
+	int32_t width;
+	int32_t height;
+	int32_t format;
+
+	// WAVE
+	uint32_t frameCount;
+	uint32_t sampleRate;
+	uint32_t sampleSize;
+	uint32_t channels;
+
+	// FONT
+	int32_t fontSize;
+	int32_t glyphCount;
+	int32_t glyphPadding;
+
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct ArchiveGlyph
+{
+	int32_t value;
+	int32_t offsetX;
+	int32_t offsetY;
+	int32_t advanceX;
+	float recX;
+	float recY;
+	float recWidth;
+	float recHeight;
+};
+
+static_assert(sizeof(ArchiveHeader) == 16);
+static_assert(sizeof(ArchiveEntry) == 128);
+static_assert(sizeof(ArchiveGlyph) == 32);
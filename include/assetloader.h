@@ -0,0 +1,120 @@
+#pragma once
+#include "raylib.h"
+#include "assetarchive.h"
+#include "mappedfile.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using AssetID = uint32_t;
+
+enum class AssetType : uint8_t
+{
+	IMAGE,
+	WAVE,
+	FONT,
+	AUDIO_DEVICE
+};
+
+/*
+* Decodes assets on worker threads. Everything is added up front, Start spins up the
+* workers and they pull jobs until there are none left. Only the CPU side is done here
+* (PNG decode, WAV decode, TTF rasterising and packing the glyph atlas), anything that
+* touches the GL context is left for the main thread once IsReady says the job is done.
+
+* Also opens the audio device as one of the jobs since that can easily take longer than
+* all the decoding put together. raylib's audio device isn't tied to the GL thread.
+
+* If a baked archive is opened first, assets are found in it by name and are ready as
+* soon as Start is called with nothing to decode. Their data points straight into the
+* mapped archive (IsBorrowed) so it must not be unloaded and only lives as long as the loader.
+* Anything not in the archive falls back to decoding the loose file under m_LooseRoot.
+
+* The Take functions hand ownership of the decoded data to the caller, anything never
+* taken is freed when the loader is destroyed.
+*/
+class AssetLoader
+{
+private:
+	struct Job
+	{
+		AssetType type { AssetType::IMAGE };
+		std::string path;
+		int fontSize { 0 };
+		int glyphCount { 0 };
+
+		Image image { 0 };
+		Wave wave { 0 };
+		Font font { 0 };
+		bool borrowed { false };
+		bool taken { false };
+	};
+
+	// Where assets are loaded from when there is no archive, relative to the working directory
+	static constexpr const char* m_LooseRoot { "../assets/" };
+
+	MappedFile m_Archive;
+	const ArchiveEntry* m_ArchiveEntries { nullptr };
+	uint32_t m_ArchiveEntryCount { 0 };
+
+	std::vector<Job> m_Jobs;
+	std::unique_ptr<std::atomic<bool>[]> m_Ready;
+	std::atomic<size_t> m_NextJob { 0 };
+	std::atomic<size_t> m_ReadyCount { 0 };
+	std::vector<std::jthread> m_Workers;
+
+	AssetID Add(const Job& job);
+	const ArchiveEntry* FindArchiveEntry(const std::string& name, ArchiveEntryType type) const;
+	bool LoadFromArchive(Job& job);
+	void RunJobs();
+	void RunJob(Job& job);
+
+public:
+	~AssetLoader();
+
+	// Maps a baked archive, returns false (and everything is loaded loose) if it's missing or out of date
+	bool OpenArchive(const char* path);
+
+	// Names are relative to the assets directory, e.g. "image/paddle.png"
+	AssetID AddImage(const char* name);
+	AssetID AddWave(const char* name);
+	// Same as LoadFontEx(name, fontSize, nullptr, glyphCount)
+	AssetID AddFont(const char* name, int fontSize, int glyphCount);
+	AssetID AddAudioDevice();
+
+	// Starts decoding on up to maxWorkers threads, nothing can be added after this
+	void Start(unsigned int maxWorkers = 4);
+
+	// Blocks until the workers have finished every job
+	void Wait();
+
+	inline bool IsReady(AssetID asset) const
+	{
+		return m_Ready && m_Ready[asset].load(std::memory_order_acquire);
+	}
+
+	inline size_t GetReadyCount() const
+	{
+		return m_ReadyCount.load(std::memory_order_relaxed);
+	}
+
+	inline size_t GetJobCount() const
+	{
+		return m_Jobs.size();
+	}
+
+	// The data points into the archive and must not be unloaded
+	inline bool IsBorrowed(AssetID asset) const
+	{
+		return m_Jobs[asset].borrowed;
+	}
+
+	// Only valid once IsReady(asset)
+	Image TakeImage(AssetID asset);
+	Wave TakeWave(AssetID asset);
+	// Glyphs and recs are filled in (and always owned by the font), the glyph atlas image still needs uploading as font.texture
+	Font TakeFont(AssetID asset, Image& atlas);
+};
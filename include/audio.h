@@ -0,0 +1,125 @@
+#pragma once
+#include "raylib.h"
+#include "random.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Audio
+{
+	using EffectID = uint16_t;
+	using VoiceID = uint32_t;
+	using VariantID = uint32_t;
+
+	/*
+	* Everything the VoicePool needs from an audio device. The game uses raylib's (sound
+	* aliases, see raylibaudio.h), the NullBackend below just keeps time so the pool can be
+	* run without an audio device. Only raylib's Wave struct is used here, nothing is linked.
+	*
+	* A variant is one pitch of an effect, resampled once when it's created so playing it
+	* never needs a pitch change. A voice is one playback slot that can play any of the variants
+	* it was created with, the variant index passed to Play is relative to those.
+	* IDs are handed out in order from 0, the pool relies on an effect's voices being consecutive.
+	*/
+	class Backend
+	{
+	public:
+		virtual ~Backend() = default;
+
+		virtual VariantID CreateVariant(const Wave& wave, float pitch) = 0;
+		virtual VoiceID CreateVoice(VariantID firstVariant, uint32_t variantCount) = 0;
+
+		virtual void Play(VoiceID voice, uint32_t variant) = 0;
+		virtual void Stop(VoiceID voice) = 0;
+		virtual bool IsPlaying(VoiceID voice) const = 0;
+	};
+
+	/*
+	* No device, a voice counts as playing for as long as its variant would have lasted.
+	* Time only moves when Advance is called so tests and benchmarks are deterministic.
+	*/
+	class NullBackend : public Backend
+	{
+	private:
+		struct Voice
+		{
+			VariantID firstVariant;
+			double endTime;
+		};
+
+		std::vector<double> m_VariantLengths;
+		std::vector<Voice> m_Voices;
+		double m_Time { 0.0 };
+
+	public:
+		VariantID CreateVariant(const Wave& wave, float pitch) override;
+		VoiceID CreateVoice(VariantID firstVariant, uint32_t variantCount) override;
+
+		void Play(VoiceID voice, uint32_t variant) override;
+		void Stop(VoiceID voice) override;
+		bool IsPlaying(VoiceID voice) const override;
+
+		inline void Advance(double seconds)
+		{
+			m_Time += seconds;
+		}
+	};
+
+	struct VoicePoolStats
+	{
+		uint64_t plays { 0 };
+
+		// Plays that had to cut off the oldest voice because every voice was busy
+		uint64_t steals { 0 };
+	};
+
+	/*
+	* A fixed number of voices per effect so overlapping hits all get heard instead of the
+	* old "skip it if the sound is already playing". When every voice of an effect is busy
+	* the one that started longest ago is cut off and reused.
+	*
+	* The pitch randomisation picks one of the variants made at load time rather than
+	* calling SetSoundPitch on a shared sound, which retuned the resampler on the audio
+	* thread every time and changed the pitch of whatever that sound was already playing.
+	*/
+	class VoicePool
+	{
+	private:
+		struct Effect
+		{
+			VoiceID firstVoice;
+			uint32_t voiceCount;
+			uint32_t variantCount;
+		};
+
+		Backend& m_Backend;
+		std::vector<Effect> m_Effects;
+
+		// Per voice, the play count when it was last started, 0 for never
+		std::vector<uint64_t> m_VoiceStarted;
+
+		Random m_Random;
+		VoicePoolStats m_Stats;
+
+	public:
+		explicit VoicePool(Backend& backend);
+
+		// The wave is copied, the caller can free it straight after
+		EffectID AddEffect(const Wave& wave, std::span<const float> pitches, uint32_t voiceCount);
+
+		// Plays a random pitch variant
+		void Play(EffectID effect);
+		void PlayVariant(EffectID effect, uint32_t variant);
+		void StopAll();
+
+		inline const VoicePoolStats& GetStats() const
+		{
+			return m_Stats;
+		}
+
+		inline size_t GetEffectCount() const
+		{
+			return m_Effects.size();
+		}
+	};
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include "gamestate.h"
+#include "simulation.h"
+
+enum class AutoplayAim
+{
+	// Under the lowest ball as it is now, loses balls that come in at an angle
+	LOWEST_BALL,
+	// Where the soonest ball it can reach will come down (see PredictLanding)
+	PREDICTED_LANDING
+};
+
+/*
+* Stands in for the player so the simulation can run unattended. Starts rounds straight
+* away, tops each round up to numBalls with multi-ball and moves the paddle to wherever
+* aim says. Used by the headless runner, the benchmarks and the game's --autoplay.
+*/
+struct Autoplayer
+{
+	int numBalls { 1 };
+	bool ballsSpawned { false };
+	AutoplayAim aim { AutoplayAim::LOWEST_BALL };
+
+	SimInput NextInput(const GameState& gameState);
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "gamestate.h"
+#include "simulation.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+/*
+* Steps lots of independent games in lock-step for training and evaluating paddle
+* controllers. Every Step takes one action per game (the paddle direction, -1 to 1) and
+* fills contiguous observation, reward and done arrays, the games are split across a pool
+* of worker threads with the calling thread helping out.
+
+* The agent only steers: rounds start on their own and a game that ends is reset straight
+* away, so the observation after a done is the first of the next game.
+
+* Observations are m_ObservationSize floats per game, positions scaled to 0-1 by the game
+* resolution:
+*	paddle centre x, fraction of the field's cells holding a brick, active ball count,
+*	then the m_ObservedBalls lowest active balls (centre x, centre y, direction x, direction y, 1),
+*	all zeroes for the slots there aren't enough balls for.
+* The reward is the score gained in bricks (a level clear counts five) and -1 on game over.
+*/
+class BatchSimulation
+{
+public:
+	static constexpr size_t m_ObservedBalls { 4 };
+	static constexpr size_t m_BallObservationSize { 5 };
+	static constexpr size_t m_ObservationSize { 3 + m_ObservedBalls * m_BallObservationSize };
+
+private:
+	static constexpr float m_PointsPerReward { 50.0f };
+
+	struct Environment
+	{
+		GameState state;
+		Simulation simulation { state };
+		int lastScore { 0 };
+	};
+
+	enum class Job
+	{
+		RESET,
+		STEP
+	};
+
+	// Simulation holds a reference to its state, so the games are allocated once and never move
+	size_t m_Count { 0 };
+	std::unique_ptr<Environment[]> m_Environments;
+	SimLayout m_Layout;
+	float m_TickLength { 1.0f / 120.0f };
+
+	std::vector<float> m_Observations;
+	std::vector<float> m_Rewards;
+	std::vector<uint8_t> m_Dones;
+
+	// The job in progress, every thread takes m_ChunkSize games at a time until they're gone.
+	// The job's fields are written before m_NextEnvironment is reset, taking a chunk reads them after
+	Job m_Job { Job::STEP };
+	const float* m_Actions { nullptr };
+	uint32_t m_Seed { 0 };
+	size_t m_ChunkSize { 1 };
+	std::atomic<size_t> m_NextEnvironment { 0 };
+	std::atomic<size_t> m_Remaining { 0 };
+
+	// Bumped to wake the workers for each job
+	std::atomic<uint32_t> m_JobGeneration { 0 };
+	std::atomic<bool> m_Stopping { false };
+	std::vector<std::jthread> m_Workers;
+
+	void WorkerLoop();
+	void Run(Job job);
+	void RunChunks();
+
+	void ResetEnvironment(size_t index);
+	void StepEnvironment(size_t index);
+	void WriteObservation(size_t index);
+
+public:
+	// threads counts the caller, 0 uses every hardware thread. The games start reset with seed 0
+	explicit BatchSimulation(size_t count, unsigned int threads = 0, float tickRate = 120.0f, const SimLayout& layout = SimLayout {});
+	~BatchSimulation();
+
+	BatchSimulation(const BatchSimulation&) = delete;
+	BatchSimulation& operator=(const BatchSimulation&) = delete;
+
+	// Every game plays this level file (see level.h) instead of the classic levels, call before Reset
+	void SetLevel(const BrickField& level);
+
+	// Starts every game from scratch, game i from seed + i, and fills the observations
+	void Reset(uint32_t seed);
+
+	// One tick of every game, actions holds one paddle direction per game (at least GetCount of them)
+	void Step(std::span<const float> actions);
+
+	inline size_t GetCount() const
+	{
+		return m_Count;
+	}
+
+	inline size_t GetThreadCount() const
+	{
+		return m_Workers.size() + 1;
+	}
+
+	// m_ObservationSize floats per game, game i's start at i * m_ObservationSize
+	inline std::span<const float> GetObservations() const
+	{
+		return m_Observations;
+	}
+
+	inline std::span<const float> GetRewards() const
+	{
+		return m_Rewards;
+	}
+
+	// 1 where the last Step ended a game
+	inline std::span<const uint8_t> GetDones() const
+	{
+		return m_Dones;
+	}
+
+	// For inspecting or rendering one game, only between calls
+	inline const GameState& GetState(size_t index) const
+	{
+		return m_Environments[index].state;
+	}
+};
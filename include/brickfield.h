@@ -0,0 +1,386 @@
+#pragma once
+#include "raylib.h"
+#include "aabbkernel.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Brick types are 4 bits in the level files, the renderer picks a sprite from the type
+constexpr int BrickTypeCount { 16 };
+constexpr int MaxBrickHitPoints { 15 };
+
+struct BrickCell
+{
+	uint8_t type { 0 };
+
+	// Hits left before the brick breaks, 0 is an empty cell
+	uint8_t hitPoints { 0 };
+};
+
+struct BrickCoord
+{
+	int column { 0 };
+	int row { 0 };
+};
+
+/*
+* Every brick in the level, stored sparsely so a 1000x1000 challenge level costs memory
+* for the bricks it has rather than for its area. Blocks used to be entities, one for
+* every cell of the 15x4 lattice whether it was showing or not.
+
+* Cells are grouped into 8x8 chunks. A chunk is a 64 bit live mask (one byte per row of
+* the chunk) plus a byte per cell with its type and hit points packed the same as the
+* level files, 72 bytes, and only exists while at least one of its bricks is live. The
+* directory has one index per chunk of the level, 4 bytes for every 64 cells, so looking
+* a cell up is two array reads and a brick never costs more than a chunk.
+
+* The field sits on a regular lattice (SetLayout), the brick in a cell is drawn and
+* collides at the start of the cell with the padding after it. The whole field drops in
+* together after a level clear, so that's one vertical offset rather than a position per brick.
+
+* Queries take rects in field space, where the field is at rest (see ToFieldSpace).
+* Nothing here knows about GameState, the simulation owns the rules.
+*/
+class BrickField
+{
+public:
+	static constexpr int m_ChunkShift { 3 };
+	static constexpr int m_ChunkSize { 1 << m_ChunkShift };
+
+private:
+	static constexpr int32_t m_NoChunk { -1 };
+
+	struct Chunk
+	{
+		uint64_t live { 0 };
+
+		// Type in the high nibble, hit points in the low one
+		uint8_t cells[m_ChunkSize * m_ChunkSize] { 0 };
+	};
+
+	static inline BrickCell Unpack(uint8_t packed)
+	{
+		return BrickCell { static_cast<uint8_t>(packed >> 4), static_cast<uint8_t>(packed & 0x0F) };
+	}
+
+	int m_Columns { 0 };
+	int m_Rows { 0 };
+	int m_ChunkColumns { 0 };
+	int m_ChunkRows { 0 };
+
+	std::vector<int32_t> m_Directory;
+	std::vector<Chunk> m_Chunks;
+	std::vector<int32_t> m_FreeChunks;
+	size_t m_LiveCount { 0 };
+
+	// Bumped whenever a brick appears, goes or takes a hit, so the renderer and the sim thread can skip frames where nothing did
+	uint32_t m_Revision { 0 };
+
+	// Bumped when the bricks are replaced wholesale or change in some way other than appearing or going
+	uint32_t m_Generation { 0 };
+
+	Vector2 m_Origin { 0.0f, 0.0f };
+	Vector2 m_Pitch { 1.0f, 1.0f };
+	Vector2 m_BrickSize { 1.0f, 1.0f };
+	float m_OffsetY { 0.0f };
+	float m_PreviousOffsetY { 0.0f };
+
+	static inline int BitOf(int column, int row)
+	{
+		return ((row & (m_ChunkSize - 1)) << m_ChunkShift) | (column & (m_ChunkSize - 1));
+	}
+
+	inline int32_t& DirectorySlot(int column, int row)
+	{
+		return m_Directory[static_cast<size_t>(row >> m_ChunkShift) * m_ChunkColumns + (column >> m_ChunkShift)];
+	}
+
+	inline int32_t DirectorySlot(int column, int row) const
+	{
+		return m_Directory[static_cast<size_t>(row >> m_ChunkShift) * m_ChunkColumns + (column >> m_ChunkShift)];
+	}
+
+	inline bool InBounds(int column, int row) const
+	{
+		return column >= 0 && column < m_Columns && row >= 0 && row < m_Rows;
+	}
+
+	int32_t AllocateChunk();
+	void FreeChunk(int32_t chunk);
+
+public:
+	// Empties the field and sizes it, the layout is kept
+	void Reset(int columns, int rows);
+
+	// Removes every brick, keeping the size and layout
+	void Clear();
+
+	// Takes another field's size, bricks and layout. Unlike assigning it counts as a change (see GetGeneration)
+	void CopyFrom(const BrickField& other);
+
+	// origin is the top left of cell 0, 0 and pitch the distance between neighbouring cells
+	void SetLayout(Vector2 origin, Vector2 pitch, Vector2 brickSize);
+
+	// A cell with 0 hit points is removed, out of range cells are ignored. Types and hit points are clamped to 4 bits
+	void Set(int column, int row, BrickCell cell);
+
+	/*
+	* Puts the same brick in every cell of a rect, clipped to the field. Works a chunk at a
+	* time, the cells are or'd into the live mask in one go and counted with a popcount,
+	* so a row of the classic level is a couple of mask ops rather than a Set per brick.
+	*/
+	void Fill(int firstColumn, int firstRow, int columns, int rows, BrickCell cell);
+	void Remove(int column, int row);
+
+	// Takes a hit point off the brick, returns true if that broke it
+	bool Hit(int column, int row);
+
+	BrickCell Get(int column, int row) const;
+
+	inline bool IsLive(int column, int row) const
+	{
+		if (!InBounds(column, row)) return false;
+		const int32_t chunk { DirectorySlot(column, row) };
+		return chunk != m_NoChunk && (m_Chunks[chunk].live >> BitOf(column, row) & 1) != 0;
+	}
+
+	inline size_t GetLiveCount() const
+	{
+		return m_LiveCount;
+	}
+
+	inline bool IsEmpty() const
+	{
+		return m_LiveCount == 0;
+	}
+
+	inline int GetColumns() const
+	{
+		return m_Columns;
+	}
+
+	inline int GetRows() const
+	{
+		return m_Rows;
+	}
+
+	inline uint32_t GetRevision() const
+	{
+		return m_Revision;
+	}
+
+	/*
+	* Changes with Reset, Clear, CopyFrom, SetLayout and Set on a brick that's already there.
+	* While it stays the same, comparing live masks is enough to know what changed.
+	*/
+	inline uint32_t GetGeneration() const
+	{
+		return m_Generation;
+	}
+
+	// Chunks that hold at least one brick, and what the field costs in bytes all in
+	size_t GetChunkCount() const;
+	size_t GetMemoryUsage() const;
+
+	// FNV-1a over the size and every live brick, the layout and offset aren't included
+	uint64_t GetHash() const;
+
+	inline int GetChunkColumns() const
+	{
+		return m_ChunkColumns;
+	}
+
+	inline int GetChunkRows() const
+	{
+		return m_ChunkRows;
+	}
+
+	// Live mask of a chunk, bit (row % 8) * 8 + (column % 8). 0 if the chunk holds nothing
+	inline uint64_t GetChunkMask(int chunkColumn, int chunkRow) const
+	{
+		const int32_t chunk { m_Directory[static_cast<size_t>(chunkRow) * m_ChunkColumns + chunkColumn] };
+		return chunk != m_NoChunk ? m_Chunks[chunk].live : 0;
+	}
+
+	inline Vector2 GetOrigin() const
+	{
+		return m_Origin;
+	}
+
+	inline Vector2 GetPitch() const
+	{
+		return m_Pitch;
+	}
+
+	inline Vector2 GetBrickSize() const
+	{
+		return m_BrickSize;
+	}
+
+	// The rect the whole field covers at rest, from the first brick to the end of the last one
+	inline Rectangle GetArea() const
+	{
+		return Rectangle { m_Origin.x, m_Origin.y,
+			m_Columns > 0 ? (m_Columns - 1) * m_Pitch.x + m_BrickSize.x : 0.0f,
+			m_Rows > 0 ? (m_Rows - 1) * m_Pitch.y + m_BrickSize.y : 0.0f };
+	}
+
+	// Where the brick in a cell is when the field is at rest
+	inline Rectangle GetCellBounds(int column, int row) const
+	{
+		return Rectangle { m_Origin.x + static_cast<float>(column) * m_Pitch.x, m_Origin.y + static_cast<float>(row) * m_Pitch.y,
+			m_BrickSize.x, m_BrickSize.y };
+	}
+
+	// Where the brick in a cell is right now, i.e. including the drop in offset
+	inline Rectangle GetBrickBounds(int column, int row) const
+	{
+		Rectangle bounds { GetCellBounds(column, row) };
+		bounds.y += m_OffsetY;
+		return bounds;
+	}
+
+	inline Rectangle ToFieldSpace(const Rectangle& bounds) const
+	{
+		return Rectangle { bounds.x, bounds.y - m_OffsetY, bounds.width, bounds.height };
+	}
+
+	// How far the field is above (negative) its resting place, while it drops in after a level clear
+	inline float GetOffsetY() const
+	{
+		return m_OffsetY;
+	}
+
+	inline float GetPreviousOffsetY() const
+	{
+		return m_PreviousOffsetY;
+	}
+
+	inline void SetOffsetY(float offsetY)
+	{
+		m_OffsetY = offsetY;
+	}
+
+	// Same as the entities' previous positions, for the renderer to interpolate from
+	inline void SnapPreviousOffset()
+	{
+		m_PreviousOffsetY = m_OffsetY;
+	}
+
+	// Just the other field's offsets, for a copy whose bricks are already the same (see SimThread)
+	inline void CopyOffsetsFrom(const BrickField& other)
+	{
+		m_OffsetY = other.m_OffsetY;
+		m_PreviousOffsetY = other.m_PreviousOffsetY;
+	}
+
+	// Calls fn(column, row, cell) for every live brick, a chunk at a time in directory order
+	template<typename Fn>
+	void ForEachLive(Fn&& fn) const
+	{
+		for (int chunkRow { 0 }; chunkRow < m_ChunkRows; chunkRow++)
+		{
+			for (int chunkColumn { 0 }; chunkColumn < m_ChunkColumns; chunkColumn++)
+			{
+				const int32_t chunk { m_Directory[static_cast<size_t>(chunkRow) * m_ChunkColumns + chunkColumn] };
+				if (chunk == m_NoChunk) continue;
+
+				const Chunk& cells { m_Chunks[chunk] };
+				uint64_t live { cells.live };
+				while (live != 0)
+				{
+					const int bit { std::countr_zero(live) };
+					live &= live - 1;
+					fn((chunkColumn << m_ChunkShift) | (bit & (m_ChunkSize - 1)), (chunkRow << m_ChunkShift) | (bit >> m_ChunkShift),
+						Unpack(cells.cells[bit]));
+				}
+			}
+		}
+	}
+
+	/*
+	* Calls fn(column, row, bits) for each chunk row the field space bounds cover, bits being
+	* the live cells of the row's 8 (bit 0 is column chunkStart) the bounds reach into.
+	* Rows with nothing live under the bounds are skipped.
+	*/
+	template<typename Fn>
+	void ForEachLiveSpan(const Rectangle& bounds, Fn&& fn) const
+	{
+		if (m_LiveCount == 0) return;
+
+		const int firstColumn { std::max(0, static_cast<int>(std::floor((bounds.x - m_Origin.x) / m_Pitch.x))) };
+		const int lastColumn { std::min(m_Columns - 1, static_cast<int>(std::floor((bounds.x + bounds.width - m_Origin.x) / m_Pitch.x))) };
+		const int firstRow { std::max(0, static_cast<int>(std::floor((bounds.y - m_Origin.y) / m_Pitch.y))) };
+		const int lastRow { std::min(m_Rows - 1, static_cast<int>(std::floor((bounds.y + bounds.height - m_Origin.y) / m_Pitch.y))) };
+
+		for (int row { firstRow }; row <= lastRow; row++)
+		{
+			const int shift { (row & (m_ChunkSize - 1)) << m_ChunkShift };
+			const int32_t* directoryRow { &m_Directory[static_cast<size_t>(row >> m_ChunkShift) * m_ChunkColumns] };
+
+			for (int chunkColumn { firstColumn >> m_ChunkShift }; chunkColumn <= (lastColumn >> m_ChunkShift); chunkColumn++)
+			{
+				const int32_t chunk { directoryRow[chunkColumn] };
+				if (chunk == m_NoChunk) continue;
+
+				const int chunkStart { chunkColumn << m_ChunkShift };
+				const int first { std::max(firstColumn, chunkStart) - chunkStart };
+				const int last { std::min(lastColumn, chunkStart + m_ChunkSize - 1) - chunkStart };
+				const uint32_t bits { static_cast<uint32_t>(m_Chunks[chunk].live >> shift) & (0xFFu << first) & (0xFFu >> (m_ChunkSize - 1 - last)) };
+				if (bits != 0) fn(chunkStart, row, bits);
+			}
+		}
+	}
+
+	/*
+	* Calls fn(column, row) for every live brick whose cell (brick plus padding) the field
+	* space bounds overlap, in row major order. Each row of the span is a byte of a chunk's
+	* mask, so empty cells are skipped 8 at a time without being looked at.
+	* The brick may be removed from inside fn.
+	*/
+	template<typename Fn>
+	void ForEachLiveCell(const Rectangle& bounds, Fn&& fn) const
+	{
+		ForEachLiveSpan(bounds, [&](int chunkStart, int row, uint32_t bits) {
+			while (bits != 0)
+			{
+				const int bit { std::countr_zero(bits) };
+				bits &= bits - 1;
+				fn(chunkStart + bit, row);
+			}
+			});
+	}
+
+	/*
+	* Same as ForEachLiveCell but only the bricks the bounds actually overlap, not the ones
+	* it just reaches the padding of. The 8 bricks of each chunk row go through
+	* OverlapMaskAABB in one call, so this is the narrowphase as well.
+	*/
+	template<typename Fn>
+	void ForEachTouchingBrick(const Rectangle& bounds, Fn&& fn) const
+	{
+		ForEachLiveSpan(bounds, [&](int chunkStart, int row, uint32_t bits) {
+			// Field space, the same sums as GetCellBounds
+			float minX[m_ChunkSize], maxX[m_ChunkSize], minY[m_ChunkSize], maxY[m_ChunkSize];
+			const float top { m_Origin.y + static_cast<float>(row) * m_Pitch.y };
+			for (int i { 0 }; i < m_ChunkSize; i++)
+			{
+				minX[i] = m_Origin.x + static_cast<float>(chunkStart + i) * m_Pitch.x;
+				maxX[i] = minX[i] + m_BrickSize.x;
+				minY[i] = top;
+				maxY[i] = top + m_BrickSize.y;
+			}
+
+			bits &= OverlapMaskAABB(bounds, minX, minY, maxX, maxY, m_ChunkSize);
+			while (bits != 0)
+			{
+				const int bit { std::countr_zero(bits) };
+				bits &= bits - 1;
+				fn(chunkStart + bit, row);
+			}
+			});
+	}
+};
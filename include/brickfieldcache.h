@@ -0,0 +1,51 @@
+#pragma once
+#include "raylib.h"
+#include "brickfield.h"
+#include "spriteatlas.h"
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+* The brick wall only changes when a brick is destroyed or the level is reset, so the
+* bricks are drawn once into a render texture at their resting place and the whole field
+* is blitted as a single quad every frame, however many bricks there are. While the field
+* drops in after a level clear the quad is just drawn further up (see BrickField::GetOffsetY).
+
+* Update skips frames where the field's revision hasn't moved, which is almost all of
+* them. Otherwise it compares each chunk's live mask with the one it baked and only touches
+* the bricks that changed: a destroyed brick has its rect cleared, a new one is drawn in.
+* If lots change at once or the generation moved (a level reset) it redraws the whole texture.
+*/
+class BrickFieldCache
+{
+private:
+	static constexpr size_t m_MaxPartialUpdates { 16 };
+
+	RenderTexture2D m_Target { 0 };
+
+	// What the texture holds, the field's revision and generation when it was baked plus one mask per chunk
+	std::vector<uint64_t> m_BakedMasks;
+	std::vector<BrickCoord> m_Changed;
+	uint32_t m_BakedRevision { 0 };
+	uint32_t m_BakedGeneration { UINT32_MAX };
+
+	static Rectangle PixelBounds(const BrickField& field, int column, int row);
+
+	void DrawBrick(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites, int column, int row) const;
+	void EraseBrick(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites, int column, int row) const;
+	void Redraw(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites);
+
+public:
+	void Load(int width, int height);
+	void Unload();
+
+	// Brings the texture up to date with the bricks, call before BeginMode2D. brickSprites is indexed by brick type (wrapping)
+	void Update(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites);
+
+	inline const Texture2D& GetTexture() const
+	{
+		return m_Target.texture;
+	}
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include "raylib.h"
+#include <algorithm>
+#include <limits>
+
+/*
+* Same test as raylib's CheckCollisionRecs but inline, so the simulation doesn't
+* have to link against raylib (and pull in a window/GL context) just for this.
+*/
+inline bool CheckCollisionAABB(const Rectangle& a, const Rectangle& b)
+{
+	return (a.x < (b.x + b.width) && (a.x + a.width) > b.x) &&
+		(a.y < (b.y + b.height) && (a.y + a.height) > b.y);
+}
+
+struct SweepHit
+{
+	// Fraction of the displacement (0-1) at which the two boxes first touch
+	float time { 1.0f };
+	// Surface normal of the box that was hit, always axis aligned
+	Vector2 normal { 0.0f, 0.0f };
+};
+
+/*
+* Swept AABB test, moves 'moving' by 'displacement' and finds when it first touches 'target'.
+* Returns false if they never touch within the displacement, or if they already overlap
+* at the start (that case is left to the discrete overlap passes).
+* On a corner hit the y axis wins, same as the discrete block bounce.
+*/
+inline bool SweepAABB(const Rectangle& moving, Vector2 displacement, const Rectangle& target, SweepHit& hit)
+{
+	constexpr float infinity { std::numeric_limits<float>::infinity() };
+
+	float entryX { -infinity };
+	float exitX { infinity };
+	if (displacement.x > 0.0f)
+	{
+		entryX = (target.x - (moving.x + moving.width)) / displacement.x;
+		exitX = ((target.x + target.width) - moving.x) / displacement.x;
+	}
+	else if (displacement.x < 0.0f)
+	{
+		entryX = ((target.x + target.width) - moving.x) / displacement.x;
+		exitX = (target.x - (moving.x + moving.width)) / displacement.x;
+	}
+	else if (moving.x >= target.x + target.width || moving.x + moving.width <= target.x)
+	{
+		return false;
+	}
+
+	float entryY { -infinity };
+	float exitY { infinity };
+	if (displacement.y > 0.0f)
+	{
+		entryY = (target.y - (moving.y + moving.height)) / displacement.y;
+		exitY = ((target.y + target.height) - moving.y) / displacement.y;
+	}
+	else if (displacement.y < 0.0f)
+	{
+		entryY = ((target.y + target.height) - moving.y) / displacement.y;
+		exitY = (target.y - (moving.y + moving.height)) / displacement.y;
+	}
+	else if (moving.y >= target.y + target.height || moving.y + moving.height <= target.y)
+	{
+		return false;
+	}
+
+	const float entry { std::max(entryX, entryY) };
+	const float exit { std::min(exitX, exitY) };
+
+	if (entry >= exit || entry < 0.0f || entry > 1.0f)
+	{
+		return false;
+	}
+
+	hit.time = entry;
+	if (entryX > entryY)
+	{
+		hit.normal = { displacement.x > 0.0f ? -1.0f : 1.0f, 0.0f };
+	}
+	else
+	{
+		hit.normal = { 0.0f, displacement.y > 0.0f ? -1.0f : 1.0f };
+	}
+	return true;
+}
\ No newline at end of file
@@ -2,11 +2,14 @@
 #include "raylib.h"
 #include <cstdint>
 
+// Dense index into the sprite atlas' table of source rects
+using SpriteID = uint16_t;
+
 struct UIElement
 {
 	Rectangle bounds { 0 };
-	unsigned int textureID { 0 };
-	unsigned int pressedTextureID { 0 };
+	SpriteID spriteID { 0 };
+	SpriteID pressedSpriteID { 0 };
 	bool isPressed { false };
 };
 
@@ -14,12 +17,11 @@ enum class EntityType
 {
 	NONE = 0,
 	PLAYER,
-	BALL,
-	BLOCK
+	BALL
 };
 
 /*
-* By using a homogenous Entity struct I can loop over entities and check by 
+* By using homogenous entities I can loop over entities and check by 
 * flag instead of by type. 
 
 * For example I can loop over all MOVABLE entities and move them without caring
@@ -30,22 +32,24 @@ enum EntityFlags : uint8_t
 	NONE = 0,
 	VISIBLE = 1 << 0,
 	MOVABLE = 1 << 1,
-	COLLIDABLE = 1 << 2,
-	ANIMATING = 1 << 3
+	COLLIDABLE = 1 << 2
 };
 
+/*
+* Describes a single entity when adding it to the EntityStore, which is where
+* the game actually keeps them (one array per field).
+*/
 struct Entity
 {
 	EntityType type { EntityType::NONE };
 	uint8_t flags { EntityFlags::NONE };
 
-	// Bind the raylib texture ID to the entity
-	unsigned int textureID { 0 };
+	// Which sprite in the atlas to draw the entity with
+	SpriteID spriteID { 0 };
 	int width { 0 };
 	int height { 0 };
 
 	Vector2 position { 0.0f, 0.0f };
-	Vector2 targetPosition { 0.0f, 0.0f };
 	Vector2 direction { 0.0f, 0.0f };
 	float moveSpeed { 0.0f };
 
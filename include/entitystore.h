@@ -0,0 +1,196 @@
+#pragma once
+#include "raylib.h"
+#include "entity.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct EntityRange
+{
+	size_t begin { 0 };
+	size_t end { 0 };
+
+	inline size_t Size() const
+	{
+		return end - begin;
+	}
+};
+
+/*
+* What a system works on, fixed at compile time: entities of one type with all of the
+* Required flags set and none of the Excluded ones. EntityStore keeps a list of the
+* matching indices for every query in EntityQueries, so a system walks just the entities
+* it wants with no type or flag tests in the loop.
+*/
+template<EntityType Type, uint8_t Required, uint8_t Excluded = EntityFlags::NONE>
+struct EntityQuery
+{
+	static constexpr EntityType type { Type };
+	static constexpr uint8_t required { Required };
+	static constexpr uint8_t excluded { Excluded };
+};
+
+// Balls in play, moved by the sweep and lost off the bottom
+using MovableBalls =		EntityQuery<EntityType::BALL, EntityFlags::MOVABLE>;
+// Balls the collision passes test
+using CollidableBalls =		EntityQuery<EntityType::BALL, EntityFlags::COLLIDABLE>;
+// Lost balls waiting to be reused by multi-ball
+using SpareBalls =			EntityQuery<EntityType::BALL, EntityFlags::NONE, EntityFlags::MOVABLE>;
+
+struct EntityQueryKey
+{
+	EntityType type;
+	uint8_t required;
+	uint8_t excluded;
+
+	constexpr bool Matches(EntityType entityType, uint8_t entityFlags) const
+	{
+		return entityType == type && (entityFlags & (required | excluded)) == required;
+	}
+};
+
+template<typename... Queries>
+struct EntityQueryList
+{
+	static constexpr std::array<EntityQueryKey, sizeof...(Queries)> keys { EntityQueryKey { Queries::type, Queries::required, Queries::excluded }... };
+};
+
+// Every query a system uses has to be here, each one costs a little on every flag change
+using EntityQueries = EntityQueryList<MovableBalls, CollidableBalls, SpareBalls>;
+
+/*
+* Structure of arrays storage for every entity in the game. Each field lives in its own
+* array so a system only streams the fields it actually touches, e.g. the wall pass
+* reads ball positions/sizes and writes directions without dragging sprite IDs through the cache.
+
+* Entities are kept sorted by EntityType (PLAYER, then BALL) so every type is
+* one contiguous range, systems iterate a Range() rather than branching on type.
+* Bricks aren't entities, they're in the GameState's BrickField.
+* An Entity is still used to describe a new entity when adding it.
+
+* Flags must only be changed with AddFlag/RemoveFlag, they keep the query lists in step.
+* The lists are unordered so a flag change is constant time: an entity joining a query goes
+* on the end and one leaving has the last one swapped into its place, found through the
+* slot every entity keeps for each query. The order only depends on the order of the
+* changes, so it's the same run to run.
+*/
+struct EntityStore
+{
+	std::vector<EntityType> types;
+	std::vector<uint8_t> flags;
+	std::vector<SpriteID> spriteIDs;
+	std::vector<Vector2> sizes;
+	std::vector<Vector2> positions;
+	std::vector<Vector2> previousPositions;
+	std::vector<Vector2> directions;
+	std::vector<float> moveSpeeds;
+
+	// Inserts at the end of the entity's type range and returns its index
+	size_t Add(const Entity& entity);
+	void Clear();
+
+	inline size_t Size() const
+	{
+		return types.size();
+	}
+
+	inline EntityRange Range(EntityType type) const
+	{
+		return m_Ranges[static_cast<size_t>(type)];
+	}
+
+	inline Rectangle GetCollider(size_t index) const
+	{
+		return Rectangle { positions[index].x, positions[index].y, sizes[index].x, sizes[index].y };
+	}
+
+	inline bool HasFlag(size_t index, uint32_t flag) const
+	{
+		return (flags[index] & flag) != 0;
+	}
+
+	inline void AddFlag(size_t index, uint32_t flag)
+	{
+		SetFlags(index, static_cast<uint8_t>(flags[index] | flag));
+	}
+
+	inline void RemoveFlag(size_t index, uint32_t flag)
+	{
+		SetFlags(index, static_cast<uint8_t>(flags[index] & ~flag));
+	}
+
+	// The indices of the entities that match the query, in no particular order
+	template<typename Query>
+	inline std::span<const uint32_t> Indices() const
+	{
+		return m_QueryIndices[QuerySlot<Query>()];
+	}
+
+	template<typename Query>
+	inline size_t Count() const
+	{
+		return m_QueryIndices[QuerySlot<Query>()].size();
+	}
+
+	/*
+	* Calls fn(index) for every entity that matches the query. fn mustn't change flags that
+	* the query depends on, use EachReverse for that.
+	*/
+	template<typename Query, typename Fn>
+	inline void Each(Fn&& fn) const
+	{
+		for (uint32_t index : m_QueryIndices[QuerySlot<Query>()])
+		{
+			fn(static_cast<size_t>(index));
+		}
+	}
+
+	// Back to front, so fn can take the entity it was given out of the query (the one swapped into its place was already visited)
+	template<typename Query, typename Fn>
+	inline void EachReverse(Fn&& fn) const
+	{
+		const std::vector<uint32_t>& indices { m_QueryIndices[QuerySlot<Query>()] };
+		for (size_t i { indices.size() }; i > 0; i--)
+		{
+			fn(static_cast<size_t>(indices[i - 1]));
+		}
+	}
+
+private:
+	static constexpr size_t m_NumEntityTypes { static_cast<size_t>(EntityType::BALL) + 1 };
+	static constexpr size_t m_NumQueries { EntityQueries::keys.size() };
+	std::array<EntityRange, m_NumEntityTypes> m_Ranges {};
+	std::array<std::vector<uint32_t>, m_NumQueries> m_QueryIndices {};
+
+	// Where each entity is in every query's list, m_NotInQuery for the ones it doesn't match
+	using QuerySlots = std::array<uint32_t, m_NumQueries>;
+	static constexpr uint32_t m_NotInQuery { UINT32_MAX };
+	static constexpr QuerySlots m_NoQuerySlots { [] {
+		QuerySlots slots;
+		slots.fill(m_NotInQuery);
+		return slots;
+		}() };
+	std::vector<QuerySlots> m_QuerySlots;
+
+	template<typename Query>
+	static constexpr size_t QuerySlot()
+	{
+		constexpr size_t slot { [] {
+			for (size_t i { 0 }; i < m_NumQueries; i++)
+			{
+				const EntityQueryKey& key { EntityQueries::keys[i] };
+				if (key.type == Query::type && key.required == Query::required && key.excluded == Query::excluded) return i;
+			}
+			return m_NumQueries;
+			}() };
+		static_assert(slot < m_NumQueries, "Add the query to EntityQueries");
+		return slot;
+	}
+
+	// Writes the flags and moves the entity into or out of any query it now does or doesn't match
+	void SetFlags(size_t index, uint8_t value);
+	void AddToQuery(size_t query, uint32_t index);
+	void RemoveFromQuery(size_t query, uint32_t index);
+};
\ No newline at end of file
@@ -3,18 +3,31 @@
 #include "raylib.h"
 #include "entity.h"
 #include "gamestate.h"
-#include <unordered_map>
+#include "simulation.h"
+#include "spriteatlas.h"
+#include "renderqueue.h"
+#include "gameview.h"
+#include "raylibrender.h"
+#include "uitext.h"
+#include "brickfieldcache.h"
+#include "assetloader.h"
+#include "audio.h"
+#include "raylibaudio.h"
+#include "replay.h"
+#include "level.h"
+#include "simthread.h"
+#include "autoplayer.h"
+#include <optional>
 
-namespace Audio
+// What main sets up from the command line, the constructor passes each one to the function of the same name below
+struct GameOptions
 {
-	inline void PlaySoundRandomisedPitch(Sound& sound)
-	{
-		constexpr int lowerBound { 95 };
-		constexpr int upperBound { 105 };
-		float pitch { GetRandomValue(lowerBound, upperBound) / 100.0f };
-		SetSoundPitch(sound, pitch);
-		PlaySound(sound);
-	}
+	const char* recordPath { nullptr };
+	const char* replayPath { nullptr };
+	const char* levelPath { nullptr };
+	// 0 steps the simulation in Update
+	float threadedTickRate { 0.0f };
+	bool autoplay { false };
 };
 
 struct CanvasTransform
@@ -26,38 +39,144 @@ struct CanvasTransform
 class GameLayer : public Layer
 {
 private:
-	GameState& m_GameState { GameState::Instance() };
+	GameState m_GameState;
+	Simulation m_Simulation { m_GameState };
+	SimInput m_Input;
+
+	// Replays, see StartRecording and StartReplay
+	ReplayRecorder m_Recorder;
+	ReplayPlayer m_Replay;
+	const char* m_RecordPath { nullptr };
+
+	// Plays the game instead of the keyboard, see StartAutoplay
+	std::optional<Autoplayer> m_Autoplayer;
+
+	// A level file from LoadLevel, read a few rows a frame while loading and handed to the simulation
+	static constexpr uint32_t m_LevelRowsPerFrame { 128 };
+	LevelReader m_LevelReader;
+	BrickField m_Level;
+	const char* m_LevelPath { nullptr };
+
+	// With SetThreadedSimulation the ticks run on m_SimThread once loading is done, 0 steps them in Update
+	SimThread m_SimThread;
+	float m_ThreadedTickLength { 0.0f };
+
+	// What drawing and input read from the game, the GameState itself or the sim thread's latest snapshot
+	GameView GetView() const;
+	uint8_t StepSimulation(SimInput& input, float deltaTime);
+	void SubmitInput();
 	Camera2D m_Camera2D { 0 };
-	std::unordered_map<unsigned int, Texture2D> m_Textures;
+	SpriteAtlas m_Atlas;
+	RenderQueue m_RenderQueue;
+	RaylibRenderBackend m_RenderBackend;
+	BrickFieldCache m_BrickFieldCache;
+
+	// Indexed by brick type, wrapping, the classic levels use one per row
+	SpriteID m_BrickSpriteIDs[GameState::m_NumBlockRows] { 0 };
+	bool m_ShowRenderStats { false };
+
+	// Assets are decoded on worker threads and uploaded a stage per frame, see ContinueLoading
+	enum class LoadStage
+	{
+		LEVEL,
+		SPRITES,
+		FONT,
+		SOUNDS,
+		DONE
+	};
+
+	struct AssetIDs
+	{
+		AssetID paddle;
+		AssetID ball;
+		AssetID blocks[GameState::m_NumBlockRows];
+		AssetID gameOverPanel;
+		AssetID buttonNormal;
+		AssetID buttonPressed;
+		AssetID font;
+		AssetID audioDevice;
+		AssetID soundButton;
+		AssetID soundBall;
+		AssetID soundBrick;
+		AssetID soundLevelComplete;
+		AssetID soundGameOver;
+	};
+
+	AssetLoader m_Assets;
+	AssetIDs m_AssetIDs { 0 };
+	LoadStage m_LoadStage { LoadStage::LEVEL };
+
+	void LoadSprites();
 
 	const Color m_BackgroundColour { 32, 32, 32, 255 };
 	CanvasTransform CalculateCanvasTransform() const;
 	
-	// sound 
-	Sound m_SoundButton;
-	Sound m_SoundBall;
-	Sound m_SoundBrick;
-	Sound m_SoundLevelComplete;
-	Sound m_SoundGameOver;
+	// sound
+	struct SoundEffects
+	{
+		Audio::EffectID button;
+		Audio::EffectID ball;
+		Audio::EffectID brick;
+		Audio::EffectID levelComplete;
+		Audio::EffectID gameOver;
+	};
+
+	Audio::RaylibBackend m_AudioBackend;
+	Audio::VoicePool m_VoicePool { m_AudioBackend };
+	SoundEffects m_Sounds { 0 };
 
 	// ui
-	Font m_Font;
+	Font m_Font { 0 };
 	UIElement m_PanelGameOver;
 	UIElement m_ButtonPlayAgain;
-	void ResetGame();
+	UIText m_ScoreText;
+	UIText m_ReadyText;
+	UIText m_StartPromptText;
+	UIText m_GameOverText;
+	UIText m_ScoreLabelText;
+	UIText m_ScoreValueText;
+	UIText m_HighLabelText;
+	UIText m_HighValueText;
 
-	void UpdateEntities(float deltaTime);
-	void HandleCollisions();
-	void HandleWallCollisions();
-	void HandleBlockCollisions();
-	void HandlePaddleCollisions();
-	void CheckGameRules();
+	void InitUIText();
+	void UpdateUILayout(const GameView& view);
+
+	void PlayEventSounds(uint8_t events);
+	void PushSprite(RenderLayer layer, SpriteID sprite, Vector2 position);
 
 public:
-	GameLayer();
+	explicit GameLayer(const GameOptions& options = GameOptions {});
 	~GameLayer() override;
 
 	bool ProcessInput() override;
 	void Update(float deltaTime) override;
-	void Draw() override;
+	void Draw(float interpolationAlpha) override;
+	float GetLoadProgress() const override;
+	void ContinueLoading() override;
+
+	/*
+	* Call before loading finishes (straight after pushing the layer, or through GameOptions
+	* when it's constructed by a transition). Recording saves
+	* every tick's input to the file when the layer is destroyed, a replay takes over the
+	* input until it runs out and then hands back to the keyboard.
+	*/
+	void StartRecording(const char* path);
+	bool StartReplay(const char* path);
+
+	// Plays a level file (see level.h) instead of the classic levels, call before loading finishes like the replays
+	bool LoadLevel(const char* path);
+
+	/*
+	* Steps the simulation on its own thread at tickRate instead of in Update, so the ticks
+	* keep their timing when a frame stalls. Call before loading finishes, the thread starts
+	* once it has. Update then only plays the sounds for whatever ticks ran since the last one.
+	*/
+	void SetThreadedSimulation(float tickRate);
+
+	/*
+	* Lets an Autoplayer aiming at the predicted landings drive the paddle and start the
+	* rounds, for leaving the game running in a soak. A replay still takes priority until it
+	* runs out. Call before loading finishes like the rest.
+	*/
+	void StartAutoplay();
 };
\ No newline at end of file
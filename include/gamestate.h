@@ -1,7 +1,9 @@
 #pragma once
 #include "raylib.h"
 #include "entity.h"
-#include <vector>
+#include "entitystore.h"
+#include "brickfield.h"
+#include "random.h"
 
 enum class GameMode
 {
@@ -11,22 +13,28 @@ enum class GameMode
 	GAME_OVER
 };
 
+/*
+* Everything a game is, a plain value with no globals behind it. Each Simulation steps the
+* one it was given, so any number of games can run side by side (see BatchSimulation).
+*/
 struct GameState
 {
-	static GameState& Instance()
-	{
-		static GameState instance;
-		return instance;
-	}
-
 	Camera2D m_Camera2D { 0 };
-	std::vector<Entity> m_Entities;
+	EntityStore m_Entities;
+	BrickField m_Bricks;
+
+	// Handles to the paddle and the ball every round starts with, set by Simulation::Init.
+	// Nothing is ever added in front of them so they don't move, systems use them instead of searching
+	size_t m_Paddle { 0 };
+	size_t m_Ball { 0 };
 
 	GameMode m_GameMode { GameMode::PAUSED };
+	Random m_Random;
 
 	int m_Score { 0 };
 	int m_HighScore { 0 };
 
+	// The classic levels, each clear widens the rows by two blocks up to the full lattice
 	int m_currentBlocksPerRow { 7 };
 	static constexpr int m_MaxBlocksPerRow { 15 };
 	static constexpr int m_BlockPadding { 2 };
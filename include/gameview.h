@@ -0,0 +1,44 @@
+#pragma once
+#include "raylib.h"
+#include "entity.h"
+#include "entitystore.h"
+#include "brickfield.h"
+#include "gamestate.h"
+#include "renderqueue.h"
+#include <span>
+
+// What drawing reads from the game, the GameState itself or the sim thread's latest snapshot
+struct GameView
+{
+	const EntityStore& entities;
+	const BrickField& bricks;
+	GameMode gameMode;
+	int score;
+	int highScore;
+};
+
+// The textures the world is drawn from
+struct GameViewSprites
+{
+	Texture2D atlas { 0 };
+	// Source rects in the atlas indexed by SpriteID
+	std::span<const Rectangle> sources;
+
+	// BrickFieldCache's render texture (stored upside down like any render texture),
+	// id 0 draws every live brick as its own sprite instead
+	Texture2D brickField { 0 };
+	// Indexed by brick type, wrapping
+	std::span<const SpriteID> brickSprites;
+
+	Color background { 32, 32, 32, 255 };
+};
+
+/*
+* Records the world part of a frame: the game area background, the bricks, every visible
+* entity interpolated between its last two ticks and the dimming over the playfield when
+* the game is paused or over. Sprites snap to whole pixels the same as DrawTexture does
+* so the pixel art stays crisp. The text and buttons on top are left to the caller, they
+* depend on the font and the layout. GameLayer::Draw and breakout_render_bench both use
+* this, so what the bench measures and hashes is what the game draws.
+*/
+void RecordGameView(RenderQueue& queue, const GameView& view, const GameViewSprites& sprites, float interpolationAlpha);
@@ -8,5 +8,16 @@ public:
 	virtual ~Layer() = default;
 	virtual bool ProcessInput() = 0;
 	virtual void Update(float deltaTime) = 0;
-	virtual void Draw() = 0;
+	// interpolationAlpha is how far we are between the last two simulation steps (0-1)
+	virtual void Draw(float interpolationAlpha) = 0;
+
+	// 0-1, for layers that load their assets over a few frames
+	virtual float GetLoadProgress() const { return 1.0f; }
+
+	/*
+	* Does the next bit of loading that has to happen on the main thread (GPU and audio
+	* uploads), a frame's worth at most. Called every frame for a layer that is being
+	* transitioned in until its progress reaches 1, see Application::TransitionLayer.
+	*/
+	virtual void ContinueLoading() {}
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+#include "brickfield.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+/*
+* Level files, the bricks a round starts with instead of the classic widening levels.
+* Baked from text by breakout_levelbaker, played with --level.
+
+*	LevelHeader
+*	one encoded row after another, top to bottom
+
+* A row is runs of bricks: a varint count of empty cells to skip, a varint count of bricks,
+* then a byte per brick with its type in the high nibble and hit points in the low one.
+* A run of 0 bricks ends the row. Empty space costs next to nothing, so a 1000x1000
+* challenge level is as big as the bricks in it and a fully packed one is a byte a brick.
+
+* Little endian structs like the replays and the asset archive.
+*/
+constexpr uint32_t LevelMagic { 0x4C564C42 }; // "BLVL"
+constexpr uint32_t LevelVersion { 1 };
+
+// Anything bigger is more likely a corrupt header than a level
+constexpr uint32_t MaxLevelSize { 1u << 14 };
+
+struct LevelHeader
+{
+	uint32_t magic { LevelMagic };
+	uint32_t version { LevelVersion };
+	uint32_t columns { 0 };
+	uint32_t rows { 0 };
+
+	// Checked once the last row is read, a short or corrupt file won't add up
+	uint64_t brickCount { 0 };
+};
+
+static_assert(sizeof(LevelHeader) == 24);
+
+/*
+* Decodes a level file into a BrickField a few rows at a time through a small fixed buffer,
+* so a huge level never has to be in memory twice and loading it can be spread over frames.
+*/
+class LevelReader
+{
+private:
+	static constexpr size_t m_BufferSize { 64 * 1024 };
+
+	std::ifstream m_File;
+	LevelHeader m_Header;
+	std::vector<uint8_t> m_Buffer;
+	size_t m_BufferOffset { 0 };
+	size_t m_BufferEnd { 0 };
+	uint32_t m_NextRow { 0 };
+	bool m_Open { false };
+
+	bool ReadByte(uint8_t& value);
+	bool ReadVarint(uint32_t& value);
+
+public:
+	// Reads and checks the header, the rows are left for ReadRows
+	bool Open(const char* path);
+
+	/*
+	* Decodes up to maxRows more rows into the field, the first call resets it to the level's size.
+	* Returns false if the file turns out to be corrupt, the reader is closed and the field
+	* should be thrown away.
+	*/
+	bool ReadRows(BrickField& field, uint32_t maxRows);
+
+	inline bool IsOpen() const
+	{
+		return m_Open;
+	}
+
+	inline bool IsDone() const
+	{
+		return m_Open && m_NextRow == m_Header.rows;
+	}
+
+	inline const LevelHeader& GetHeader() const
+	{
+		return m_Header;
+	}
+
+	// 0 - 1, how many of the rows have been read
+	inline float GetProgress() const
+	{
+		return m_Header.rows > 0 ? static_cast<float>(m_NextRow) / static_cast<float>(m_Header.rows) : 1.0f;
+	}
+};
+
+// Reads a whole level in one go
+bool LoadLevel(const char* path, BrickField& field);
+bool SaveLevel(const char* path, const BrickField& field);
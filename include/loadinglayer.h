@@ -0,0 +1,16 @@
+#pragma once
+#include "layer.h"
+
+/*
+* Shown while Application::TransitionLayer builds and loads the next layer, draws a
+* progress bar and swallows input. The transition swaps it out once the new layer has
+* loaded and fades its last frame out over it. Only uses raylib's default font and
+* shapes so it has nothing of its own to load.
+*/
+class LoadingLayer : public Layer
+{
+public:
+	bool ProcessInput() override;
+	void Update(float deltaTime) override;
+	void Draw(float interpolationAlpha) override;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/*
+* Read only memory mapped file, the OS pages it in on demand and the bytes can be handed
+* straight to raylib without copying them into our own buffers first.
+*/
+class MappedFile
+{
+private:
+	const uint8_t* m_Data { nullptr };
+	size_t m_Size { 0 };
+
+#if defined(_WIN32)
+	void* m_File { nullptr };
+	void* m_Mapping { nullptr };
+#endif
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const char* path);
+	void Close();
+
+	inline const uint8_t* GetData() const
+	{
+		return m_Data;
+	}
+
+	inline size_t GetSize() const
+	{
+		return m_Size;
+	}
+
+	inline bool IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+};
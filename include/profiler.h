@@ -0,0 +1,157 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+* Scoped timing zones, e.g. PROFILE_ZONE("Simulation::SweepBalls"); at the top of a block.
+* Each thread records finished zones into its own ring buffer with no locking, the main
+* thread reads them back for the overlay (ProfilerLayer) and the Chrome trace dump
+* (open it in chrome://tracing or ui.perfetto.dev).
+*
+* Built with BREAKOUT_PROFILER (the BREAKOUT_ENABLE_PROFILER CMake option) the zones also
+* check Profiler::IsEnabled() so the headless runner and benchmarks, which never enable it,
+* only pay for a branch. Without it the macros are empty and nothing is left in the code.
+*/
+
+struct ProfileEvent
+{
+	// Zone names must be string literals, only the pointer is kept
+	const char* name;
+	int64_t start;
+	int64_t end;
+	uint32_t depth;
+};
+
+/*
+* Written only by its own thread. The write index is published with release after each
+* event so a reader that acquires it sees whole events, as long as the writer hasn't lapped
+* it while it was copying (CopyEvents checks for that and drops whatever might be torn).
+*/
+struct ProfileThreadBuffer
+{
+	static constexpr size_t m_Capacity { 1 << 14 };
+
+	std::array<ProfileEvent, m_Capacity> events;
+	std::atomic<uint64_t> head { 0 };
+	uint32_t depth { 0 };
+	uint32_t threadIndex { 0 };
+	char threadName[32] { 0 };
+
+	inline void Push(const ProfileEvent& event)
+	{
+		const uint64_t index { head.load(std::memory_order_relaxed) };
+		events[index & (m_Capacity - 1)] = event;
+		head.store(index + 1, std::memory_order_release);
+	}
+
+	// Appends the events that finished at or after since, oldest first
+	void CopyEvents(int64_t since, std::vector<ProfileEvent>& out) const;
+};
+
+struct ProfileFrameStats
+{
+	double p50Ms { 0.0 };
+	double p99Ms { 0.0 };
+	double maxMs { 0.0 };
+	size_t frameCount { 0 };
+};
+
+class Profiler
+{
+private:
+	static constexpr size_t m_FrameHistory { 240 };
+
+	// Static so a disabled zone is one load and a branch, no trip through Instance()
+	static inline std::atomic<bool> m_Enabled { false };
+	const int64_t m_Epoch;
+
+	// Buffers live until exit so a trace still has the events of threads that have finished
+	mutable std::mutex m_BuffersMutex;
+	std::vector<std::unique_ptr<ProfileThreadBuffer>> m_Buffers;
+
+	// Main thread only, the time of every MarkFrame for the frame time percentiles
+	std::array<int64_t, m_FrameHistory> m_FrameStarts { 0 };
+	uint64_t m_FrameCount { 0 };
+	ProfileThreadBuffer* m_MainBuffer { nullptr };
+
+	Profiler();
+	ProfileThreadBuffer& RegisterThread();
+
+public:
+	static Profiler& Instance();
+
+	static inline bool IsEnabled()
+	{
+		return m_Enabled.load(std::memory_order_relaxed);
+	}
+
+	static inline void SetEnabled(bool enabled)
+	{
+		m_Enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	// Nanoseconds since the profiler was created
+	int64_t Now() const;
+
+	ProfileThreadBuffer& GetThreadBuffer();
+	void SetThreadName(const char* name);
+
+	// Call once at the start of every frame on the main thread
+	void MarkFrame();
+	ProfileFrameStats GetFrameStats() const;
+
+	// The start of the oldest frame still in the frame history
+	int64_t GetHistoryStart() const;
+
+	// Main thread (whichever calls MarkFrame) events that finished since the given time
+	void CopyMainThreadEvents(int64_t since, std::vector<ProfileEvent>& out) const;
+
+	bool WriteChromeTrace(const char* path) const;
+};
+
+class ProfileZone
+{
+private:
+	ProfileThreadBuffer* m_Buffer { nullptr };
+	const char* m_Name;
+	int64_t m_Start { 0 };
+
+public:
+	explicit ProfileZone(const char* name)
+		: m_Name { name }
+	{
+		if (!Profiler::IsEnabled()) return;
+
+		Profiler& profiler { Profiler::Instance() };
+		m_Buffer = &profiler.GetThreadBuffer();
+		m_Buffer->depth++;
+		m_Start = profiler.Now();
+	}
+
+	~ProfileZone()
+	{
+		if (m_Buffer == nullptr) return;
+
+		m_Buffer->depth--;
+		m_Buffer->Push(ProfileEvent { m_Name, m_Start, Profiler::Instance().Now(), m_Buffer->depth });
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#if defined(BREAKOUT_PROFILER)
+	#define PROFILE_CONCAT_INNER(a, b) a##b
+	#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+	#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__) { name }
+	#define PROFILE_FRAME() Profiler::Instance().MarkFrame()
+	#define PROFILE_THREAD(name) Profiler::Instance().SetThreadName(name)
+#else
+	#define PROFILE_ZONE(name)
+	#define PROFILE_FRAME()
+	#define PROFILE_THREAD(name)
+#endif
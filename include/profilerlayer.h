@@ -0,0 +1,37 @@
+#pragma once
+#include "layer.h"
+#include "profiler.h"
+#include <vector>
+
+/*
+* Sits on top of everything and draws the profiler overlay in window space: frame time
+* p50/p99/max over the last few seconds and the average time per frame of every main
+* thread zone. F2 toggles it, F4 writes a Chrome trace of everything still in the ring
+* buffers to profile.json next to the executable.
+*
+* The numbers are only gathered a couple of times a second so the overlay doesn't show up
+* in its own measurements much.
+*/
+class ProfilerLayer : public Layer
+{
+private:
+	struct ZoneSummary
+	{
+		const char* name;
+		double msPerFrame;
+		uint32_t depth;
+	};
+
+	bool m_ShowOverlay { false };
+	int m_FramesUntilRefresh { 0 };
+	ProfileFrameStats m_FrameStats;
+	std::vector<ZoneSummary> m_Zones;
+	std::vector<ProfileEvent> m_Events;
+
+	void Refresh();
+
+public:
+	bool ProcessInput() override;
+	void Update(float deltaTime) override;
+	void Draw(float interpolationAlpha) override;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+/*
+* Small xorshift generator for the simulation. Using our own instead of raylib's
+* GetRandomValue keeps the simulation free of raylib and means a game can be
+* replayed exactly from its seed.
+*/
+struct Random
+{
+	uint32_t state { 0x9E3779B9u };
+
+	inline void Seed(uint32_t seed)
+	{
+		// xorshift gets stuck on 0
+		state = seed != 0 ? seed : 0x9E3779B9u;
+	}
+
+	inline uint32_t Next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	// Uniform float in [min, max)
+	inline float Range(float min, float max)
+	{
+		return min + (max - min) * static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+	}
+};
\ No newline at end of file
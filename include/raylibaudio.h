@@ -0,0 +1,45 @@
+#pragma once
+#include "audio.h"
+#include "raylib.h"
+#include <vector>
+
+namespace Audio
+{
+	/*
+	* Variants are full sounds, each voice is a set of aliases of its effect's variants
+	* (aliases share the variant's samples so they cost a buffer header, not a copy).
+	* Needs the audio device open for the whole of its life, call Unload before closing it.
+	*/
+	class RaylibBackend : public Backend
+	{
+	private:
+		struct Voice
+		{
+			// Index into m_Aliases of the alias for variant 0
+			uint32_t firstAlias;
+
+			// Alias that was last played, -1 if none
+			int32_t playing;
+		};
+
+		std::vector<Sound> m_Variants;
+		std::vector<Sound> m_Aliases;
+		std::vector<Voice> m_Voices;
+
+	public:
+		RaylibBackend() = default;
+		~RaylibBackend() override;
+
+		RaylibBackend(const RaylibBackend&) = delete;
+		RaylibBackend& operator=(const RaylibBackend&) = delete;
+
+		VariantID CreateVariant(const Wave& wave, float pitch) override;
+		VoiceID CreateVoice(VariantID firstVariant, uint32_t variantCount) override;
+
+		void Play(VoiceID voice, uint32_t variant) override;
+		void Stop(VoiceID voice) override;
+		bool IsPlaying(VoiceID voice) const override;
+
+		void Unload();
+	};
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include "renderbackend.h"
+
+// Straight through to raylib's batch, needs the window (GL context) open
+class RaylibRenderBackend : public RenderBackend
+{
+public:
+	void DrawSprite(const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint) override;
+	void FillRectangle(const Rectangle& rectangle, Color colour) override;
+	void DrawTextRun(const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour) override;
+};
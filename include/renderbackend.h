@@ -0,0 +1,22 @@
+#pragma once
+#include "raylib.h"
+
+/*
+* What RenderQueue::Submit draws its sorted commands with. The game uses raylib's
+* (raylibrender.h), SoftwareRenderBackend rasterizes into a CPU framebuffer so the draw
+* path can be benchmarked and checked on machines with no GPU. Only raylib's structs are
+* used here, nothing is linked.
+
+* Coordinates are whatever the caller has set up, the game draws in game resolution
+* coordinates inside BeginMode2D.
+*/
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() = default;
+
+	// Same as DrawTexturePro with no origin or rotation, a negative source size flips the sprite
+	virtual void DrawSprite(const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint) = 0;
+	virtual void FillRectangle(const Rectangle& rectangle, Color colour) = 0;
+	virtual void DrawTextRun(const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour) = 0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include "raylib.h"
+#include "renderbackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Draw order, lower layers are drawn first. Within a layer commands are grouped by
+* texture so anything that has to draw on top of something with a different texture
+* (text on a panel) needs its own layer.
+*/
+enum RenderLayer : uint8_t
+{
+	RENDER_LAYER_BACKGROUND = 0,
+	RENDER_LAYER_WORLD,
+	RENDER_LAYER_HUD,
+	RENDER_LAYER_OVERLAY,
+	RENDER_LAYER_UI,
+	RENDER_LAYER_UI_TEXT
+};
+
+enum class RenderCommandType : uint8_t
+{
+	SPRITE,
+	RECTANGLE,
+	TEXT
+};
+
+struct RenderCommand
+{
+	RenderCommandType type { RenderCommandType::SPRITE };
+	Color tint { WHITE };
+
+	// Sprites and rectangles (rectangles are keyed by the shapes texture, see SetShapesTexture)
+	Texture2D texture { 0 };
+	Rectangle source { 0 };
+	Rectangle destination { 0 };
+
+	// Text, the string lives in the queue's text buffer
+	const Font* font { nullptr };
+	uint32_t textOffset { 0 };
+	float fontSize { 0.0f };
+	float spacing { 0.0f };
+};
+
+struct RenderStats
+{
+	int commands { 0 };
+	// Texture changes, each one is a separate GL draw call inside raylib's batch
+	int drawCalls { 0 };
+	// Times raylib's batch has to be uploaded and drawn, either because it filled up or at the end of the frame
+	int batchFlushes { 0 };
+};
+
+/*
+* Per-frame command buffer. GameLayer::Draw records everything it wants drawn and Submit
+* sorts it by (layer, texture, depth) and issues it in one pass, so raylib only switches
+* texture when the sorted order does rather than every time the entity order happens to.
+* The commands go to a RenderBackend, raylib's in the game or the software one (no GPU).
+
+* Each command gets a 64 bit key: layer (8) | texture (16) | depth (16) | command index (24).
+* Only the keys are sorted, the index in the low bits keeps equal keys in submission order.
+* Buffers keep their capacity between frames so recording doesn't allocate once warmed up.
+*/
+class RenderQueue
+{
+private:
+	static constexpr uint64_t m_IndexMask { (1ull << 24) - 1 };
+
+	std::vector<RenderCommand> m_Commands;
+	std::vector<uint64_t> m_SortKeys;
+	std::vector<char> m_TextBuffer;
+	RenderStats m_Stats;
+	unsigned int m_ShapesTexture { 0 };
+
+	void Push(RenderLayer layer, uint16_t depth, const RenderCommand& command);
+
+public:
+	// Clears last frame's commands
+	void Begin();
+
+	// Whatever raylib's SetShapesTexture was given, so rectangles sort (and batch) along with it
+	inline void SetShapesTexture(const Texture2D& texture)
+	{
+		m_ShapesTexture = texture.id;
+	}
+
+	void PushSprite(RenderLayer layer, const Texture2D& texture, const Rectangle& source, Vector2 position, Color tint = WHITE, uint16_t depth = 0);
+	// Same but stretched to fill the destination, e.g. the glyphs of a scaled font
+	void PushSprite(RenderLayer layer, const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint = WHITE, uint16_t depth = 0);
+	void PushRectangle(RenderLayer layer, const Rectangle& rectangle, Color colour, uint16_t depth = 0);
+	void PushText(RenderLayer layer, const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour, uint16_t depth = 0);
+
+	// Sorts and draws everything, for raylib's backend call inside BeginDrawing/BeginMode2D
+	void Submit(RenderBackend& backend);
+
+	// Recorded since Begin
+	inline size_t GetCommandCount() const
+	{
+		return m_Commands.size();
+	}
+
+	// Counters from the last Submit
+	inline const RenderStats& GetStats() const
+	{
+		return m_Stats;
+	}
+
+	/*
+	* FNV-1a over what was recorded since Begin, in the order Submit would draw it: each
+	* command's layer, texture and depth from its key, then its rects, tint and text. The font
+	* is left out since it's a pointer. For checking a recording without rasterizing it.
+	*/
+	uint64_t GetHash() const;
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include "simulation.h"
+#include <cstdint>
+#include <vector>
+
+/*
+* Replay files, every tick's SimInput and delta time plus what the simulation was started
+* with, enough to step a session again exactly on the same build. Written by the GameLayer
+* (--record) or the headless runner, played back by either (--replay). A session on a level
+* file only keeps the level's hash, the same file has to be given with --level to play it back.
+
+*	ReplayHeader
+*	runs until the end of the file
+
+* A run is a varint tick count followed by one input that was the same for all of those
+* ticks. Holding a direction or doing nothing for seconds at a time is one run, so a few
+* minutes of play is a few KB. The input is a flags byte (ReplayInputFlags) and then only
+* the fields that need more than the flags to say, see ReplayRecorder::WriteRun.
+
+* Plain little endian structs like the asset archive, replays aren't portable between builds
+* anyway since they depend on the exact float behaviour of the simulation.
+*/
+constexpr uint32_t ReplayMagic { 0x4C505242 }; // "BRPL"
+constexpr uint32_t ReplayVersion { 1 };
+
+struct ReplayHeader
+{
+	uint32_t magic { ReplayMagic };
+	uint32_t version { ReplayVersion };
+	uint32_t seed { 0 };
+
+	// Entity sizes from SimLayout, the game takes them from the sprites
+	int32_t paddleWidth { 0 };
+	int32_t paddleHeight { 0 };
+	int32_t ballWidth { 0 };
+	int32_t ballHeight { 0 };
+	int32_t blockWidth { 0 };
+	int32_t blockHeight { 0 };
+
+	// Low 32 bits of the level file's BrickField::GetHash, 0 for the classic levels
+	uint32_t levelHash { 0 };
+	uint64_t tickCount { 0 };
+};
+
+static_assert(sizeof(ReplayHeader) == 48);
+
+// Most balls one run can spawn. The game asks for 100 a press of M and the autoplayer for its
+// ball count less one at the start of a round, anything past this is a broken file rather than
+// something to allocate entities for
+constexpr int ReplayMaxSpawnBalls { 100000 };
+
+enum ReplayInputFlags : uint8_t
+{
+	// Bits 0-1, the paddle direction, REPLAY_DIRECTION_RAW has the float after the flags
+	REPLAY_DIRECTION_NONE = 0,
+	REPLAY_DIRECTION_LEFT = 1,
+	REPLAY_DIRECTION_RIGHT = 2,
+	REPLAY_DIRECTION_RAW = 3,
+	REPLAY_DIRECTION_MASK = 3,
+
+	REPLAY_CONFIRM = 1 << 2,
+
+	// Zigzag varint ball count follows, 0 to ReplayMaxSpawnBalls
+	REPLAY_SPAWN_BALLS = 1 << 3,
+
+	// The delta time changed from the previous run, the new float follows
+	REPLAY_DELTA_TIME = 1 << 4
+};
+
+/*
+* Collects a session in memory and writes it out in one go with Save, recording a tick
+* is a compare and at most a few bytes pushed onto a vector.
+*/
+class ReplayRecorder
+{
+private:
+	ReplayHeader m_Header;
+	std::vector<uint8_t> m_Data;
+	bool m_Recording { false };
+
+	// The run being counted, only written once a different input comes along
+	SimInput m_RunInput;
+	float m_RunDeltaTime { 0.0f };
+	uint64_t m_RunLength { 0 };
+	float m_WrittenDeltaTime { 0.0f };
+
+	void WriteRun();
+
+public:
+	void Begin(uint32_t seed, const SimLayout& layout, uint32_t levelHash = 0);
+	void Record(const SimInput& input, float deltaTime);
+
+	// Ends the recording and writes the file, returns false if it couldn't be written
+	bool Save(const char* path);
+
+	inline bool IsRecording() const
+	{
+		return m_Recording;
+	}
+
+	inline uint64_t GetTickCount() const
+	{
+		return m_Header.tickCount;
+	}
+};
+
+/*
+* Loads a whole replay into memory and decodes it a tick at a time, so playing one back
+* headless costs no more than the simulation steps themselves.
+*/
+class ReplayPlayer
+{
+private:
+	ReplayHeader m_Header;
+	std::vector<uint8_t> m_Data;
+	size_t m_ReadOffset { 0 };
+	bool m_Playing { false };
+
+	SimInput m_RunInput;
+	float m_RunDeltaTime { 0.0f };
+	uint64_t m_RunTicksLeft { 0 };
+	uint64_t m_TicksPlayed { 0 };
+
+	bool ReadRun();
+
+public:
+	bool Load(const char* path);
+
+	// Entity sizes to Init the simulation with, sprite IDs are left at 0
+	SimLayout GetLayout() const;
+
+	// The next tick's input and delta time, false once the replay is over
+	bool Next(SimInput& input, float& deltaTime);
+
+	inline const ReplayHeader& GetHeader() const
+	{
+		return m_Header;
+	}
+
+	inline bool IsPlaying() const
+	{
+		return m_Playing;
+	}
+
+	inline uint64_t GetTicksPlayed() const
+	{
+		return m_TicksPlayed;
+	}
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include "gamestate.h"
+#include "simulation.h"
+#include "triplebuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+/*
+* What the renderer needs from a tick, copied out of the GameState at the end of it.
+* The bricks are only copied when they changed (see SimThread::Publish), the rest every tick.
+*/
+struct SimSnapshot
+{
+	EntityStore entities;
+	BrickField bricks;
+	GameMode gameMode { GameMode::PAUSED };
+	int score { 0 };
+	int highScore { 0 };
+	uint64_t tick { 0 };
+
+	// When the tick was stepped, the renderer interpolates from previousPositions to positions over the tick after it
+	std::chrono::steady_clock::time_point stepTime;
+};
+
+/*
+* Steps the simulation on its own thread at a fixed rate, so a slow frame (a vsync miss, a
+* texture upload, the window being dragged) doesn't hold back the ticks queued behind it
+* and they keep their spacing.
+
+* After every tick the render-relevant state goes into a triple buffer, the main thread
+* takes the latest with AcquireSnapshot and never waits on the sim or reads the GameState
+* while it is being stepped. Input goes the other way through SubmitInput and the tick
+* events pile up until TakeEvents, so a frame that skips a few ticks still hears them.
+
+* Once Start is called the thread owns the GameState and everything the tick function
+* touches, until Stop.
+*/
+class SimThread
+{
+public:
+	// Called on the sim thread once a tick, returns the SimEvents it raised
+	using TickFunction = std::function<uint8_t(const SimInput& input, float deltaTime)>;
+
+private:
+	const GameState* m_GameState { nullptr };
+	TickFunction m_Tick;
+	float m_TickLength { 1.0f / 120.0f };
+	std::chrono::steady_clock::duration m_TickDuration { 0 };
+	int m_MaxCatchUpSteps { 8 };
+	uint64_t m_TickCount { 0 };
+
+	// When the last tick was due rather than when it ran, so interpolation follows the tick schedule and not the thread's wake ups
+	std::chrono::steady_clock::time_point m_LastTickTime;
+	std::jthread m_Thread;
+
+	TripleBuffer<SimSnapshot> m_Snapshots;
+
+	// Input from the main thread. The paddle follows the latest value, presses are kept until a tick takes them
+	std::atomic<float> m_PaddleDirection { 0.0f };
+	std::atomic<bool> m_Confirm { false };
+	std::atomic<int> m_SpawnBalls { 0 };
+
+	std::atomic<uint8_t> m_Events { EVENT_NONE };
+
+	void Run(std::stop_token stopToken);
+	SimInput TakeInput();
+	void Publish();
+
+public:
+	SimThread() = default;
+	~SimThread();
+
+	SimThread(const SimThread&) = delete;
+	SimThread& operator=(const SimThread&) = delete;
+
+	/*
+	* Publishes the state as it is now so there is a snapshot straight away, then starts
+	* ticking every tickLength seconds. Like Application::SetFixedTimestep, when the thread
+	* is more than maxCatchUpSteps ticks behind the backlog is dropped.
+	*/
+	void Start(const GameState& gameState, float tickLength, TickFunction tick, int maxCatchUpSteps = 8);
+	void Stop();
+
+	inline bool IsRunning() const
+	{
+		return m_Thread.joinable();
+	}
+
+	// Main thread
+	void SubmitInput(const SimInput& input);
+	uint8_t TakeEvents();
+
+	// Main thread, moves to the latest snapshot if there is a newer one. Returns false if not
+	inline bool AcquireSnapshot()
+	{
+		return m_Snapshots.Acquire();
+	}
+
+	inline const SimSnapshot& GetSnapshot() const
+	{
+		return m_Snapshots.GetReadSlot();
+	}
+
+	// How far the snapshot's tick is through to the next one at time, for interpolating
+	float GetInterpolationAlpha(std::chrono::steady_clock::time_point time) const;
+
+	inline float GetTickLength() const
+	{
+		return m_TickLength;
+	}
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include "gamestate.h"
+#include "brickfield.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+* Everything the simulation needs from the player for one step. The GameLayer
+* fills this from the keyboard and mouse, the headless runner fills it from code.
+*/
+struct SimInput
+{
+	float paddleDirection { 0.0f };
+
+	// Space/enter or the play again button, starts a round or restarts after game over
+	bool confirm { false };
+
+	// Multi-ball, extra balls to launch this step (ignored unless PLAYING)
+	int spawnBalls { 0 };
+};
+
+/*
+* The simulation doesn't know about audio, instead each step returns a mask of
+* what happened so the caller can decide which sounds to play.
+*/
+enum SimEvents : uint8_t
+{
+	EVENT_NONE = 0,
+	EVENT_WALL_HIT = 1 << 0,
+	EVENT_PADDLE_HIT = 1 << 1,
+	EVENT_BLOCK_HIT = 1 << 2,
+	EVENT_LEVEL_COMPLETE = 1 << 3,
+	EVENT_GAME_OVER = 1 << 4
+};
+
+/*
+* Entity sizes come from the sprites, the defaults match the images in assets/image
+* so the headless runner doesn't have to load any textures.
+* Sprite IDs are only carried through to the entities for the renderer, bricks aren't
+* entities so the renderer picks their sprites from the brick type itself.
+*/
+struct SimLayout
+{
+	int paddleWidth { 72 };
+	int paddleHeight { 8 };
+	int ballWidth { 12 };
+	int ballHeight { 12 };
+	int blockWidth { 30 };
+	int blockHeight { 16 };
+
+	SpriteID paddleSpriteID { 0 };
+	SpriteID ballSpriteID { 0 };
+};
+
+/*
+* All the gameplay logic with no dependency on a window, GL context or audio device.
+* Only uses raylib's types and the header-only raymath, so it can be stepped
+* from the headless runner on a machine without a GPU.
+*/
+class Simulation
+{
+private:
+	GameState& m_GameState;
+	uint8_t m_Events { EVENT_NONE };
+
+	// The bricks every round of a level file starts with, the classic levels are generated instead
+	std::optional<BrickField> m_Level;
+
+	/*
+	* Ball vs ball broadphase, a uniform grid over the playfield rebuilt every step. Cells are
+	* at least a ball across and each ball is filed under the cell its top left corner is in,
+	* so two balls can only overlap if their cells touch. The balls are counting sorted by
+	* cell, a cell's are m_BallGridCounts[cell] entries from m_BallGridEntries[m_BallGridStarts[cell]],
+	* each with a copy of its bounds so the tests read one contiguous array. The counts are
+	* all zero between steps, the starts are only meaningful for occupied cells.
+	*/
+	struct BallGridEntry
+	{
+		float minX;
+		float maxX;
+		float minY;
+		float maxY;
+		uint32_t ball;
+		uint32_t contacts;
+	};
+	std::vector<BallGridEntry> m_BallGridEntries;
+	std::vector<uint32_t> m_BallGridCounts;
+	std::vector<uint32_t> m_BallGridStarts;
+	// Each ball's cell in the order they were filed, and the cells with balls in
+	std::vector<uint32_t> m_BallGridCells;
+	std::vector<uint32_t> m_BallGridOccupied;
+
+	// Most impacts a single ball resolves in one step, the rest of its movement is dropped
+	static constexpr int m_MaxBallImpactsPerStep { 8 };
+
+	// Most other balls one ball is pushed apart from in one step. Reached once balls pile up, from about a
+	// thousand on screen. Whatever is left overlapping is seen to next step, if that ball isn't at the cap again
+	static constexpr uint32_t m_MaxBallContactsPerStep { 4 };
+
+	// Overlapping pairs the cap left unresolved since Init, so what it costs is measured rather than hidden
+	uint64_t m_DroppedBallContacts { 0 };
+
+	// Called at the start of every step, and again after teleporting entities (resets, respawns)
+	// so the renderer doesn't interpolate across the jump
+	void SnapPreviousPositions();
+
+	// Lays the field out under the score, scaled down to fit if the level is bigger than the classic one
+	void LayoutBricks(BrickField& bricks) const;
+	void FillBricks();
+
+	void HitBrick(BrickCoord brick);
+	Vector2 PaddleBounceDirection(const Rectangle& ballBounds, const Rectangle& paddleBounds) const;
+
+public:
+	explicit Simulation(GameState& gameState);
+
+	/*
+	* Plays the bricks of a level file (see level.h) instead of the classic levels, every
+	* round and level clear starts again from this field. Call before Init, an empty field
+	* goes back to the classic levels.
+	*/
+	void SetLevel(BrickField level);
+
+	// Everything random in a game comes from the seed, the same seed and inputs replay the same game
+	void Init(const SimLayout& layout, uint32_t seed = 0);
+	void ResetGame();
+
+	// Advances the game by deltaTime seconds and returns the SimEvents that happened
+	uint8_t Step(const SimInput& input, float deltaTime);
+
+	/*
+	* Multi-ball, launches count extra balls from random spots between the blocks and the
+	* paddle, reusing balls that were lost before adding new entities.
+	* A round ends when the last active (MOVABLE) ball falls out, ResetGame goes back to one ball.
+	*/
+	void SpawnBalls(int count);
+	int GetActiveBallCount() const;
+
+	// Ball pairs that overlapped but weren't pushed apart because one of them was at m_MaxBallContactsPerStep, since Init
+	inline uint64_t GetDroppedBallContacts() const
+	{
+		return m_DroppedBallContacts;
+	}
+
+	// The individual passes of a PLAYING step
+	void UpdateEntities(float deltaTime);
+
+	// Moves the balls with swept collision against walls, paddles and blocks,
+	// resolving every impact in time order so fast balls can't tunnel
+	void SweepBalls(float deltaTime);
+
+	// Discrete overlap passes, after the sweep these only catch things that moved
+	// into a ball (the paddle sliding sideways, blocks dropping in on respawn)
+	void HandleCollisions();
+	void HandleBallCollisions();
+	void HandleWallCollisions();
+	void HandleBlockCollisions();
+	void HandlePaddleCollisions();
+	void CheckGameRules();
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include "raylib.h"
+#include "entity.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+* Packs every sprite into a single texture when the game loads. Entities carry a dense
+* SpriteID which indexes straight into the table of source rects, so drawing is an array
+* lookup instead of a hash lookup and every sprite draw uses the same texture, meaning
+* raylib can batch the whole frame without flushing on texture switches.
+
+* Sprites are packed into shelves (tallest first) with a 1px border around each one,
+* the border repeats the sprite's edge pixels so nothing bleeds in from a neighbour
+* when the canvas is scaled.
+*/
+class SpriteAtlas
+{
+private:
+	static constexpr int m_Padding { 1 };
+
+	Texture2D m_Texture { 0 };
+	std::vector<Rectangle> m_Sources;
+
+	// Images waiting for Build, indexed by SpriteID
+	std::vector<Image> m_Images;
+	std::vector<uint8_t> m_OwnsImage;
+
+public:
+	// Loads the image and returns the ID it will have in the atlas, call Build once everything is added
+	SpriteID Add(const char* path);
+
+	// Same as above for an image that's already in memory. The atlas frees it after Build
+	// if owned, otherwise it's only read (e.g. pixels in a mapped asset archive)
+	SpriteID Add(Image image, bool owned = true);
+
+	// Packs every added image into the atlas texture and frees the images
+	void Build();
+	void Unload();
+
+	inline const Texture2D& GetTexture() const
+	{
+		return m_Texture;
+	}
+
+	inline const Rectangle& GetSource(SpriteID sprite) const
+	{
+		return m_Sources[sprite];
+	}
+
+	// Every source rect, indexed by SpriteID
+	inline std::span<const Rectangle> GetSources() const
+	{
+		return m_Sources;
+	}
+};
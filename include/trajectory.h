@@ -0,0 +1,47 @@
+#pragma once
+#include "raylib.h"
+#include "globals.h"
+#include <cmath>
+#include <limits>
+
+struct BallLanding
+{
+	// The ball's centre x when its bottom edge reaches the line
+	float x { 0.0f };
+	// Seconds until then, infinite if it never will
+	float time { std::numeric_limits<float>::infinity() };
+};
+
+/*
+* Where a ball will come down to lineY (the top of the paddle), worked out in one go
+* instead of stepping it there. It bounces off the side walls and the ceiling the same as
+* the sweep and HandleWallCollisions, so unfolding the bounces straightens its path: the
+* ceiling just adds the way up to how far it has to fall, and the x it would reach with no
+* side walls folds back into the playfield as a triangle wave.
+
+* A handful of flops and a floor a ball, so it is fine for every ball every tick. Bricks,
+* the paddle and other balls aren't taken into account, it is right to within a tick's
+* travel for a ball with a clear run down and a best guess for one still among the bricks.
+* A ball already below the line (or moving flat) never lands.
+*/
+inline BallLanding PredictLanding(Vector2 position, Vector2 size, Vector2 direction, float speed, float lineY)
+{
+	BallLanding landing;
+	landing.x = position.x + size.x * 0.5f;
+	if (direction.y == 0.0f || speed <= 0.0f) return landing;
+
+	// Falling it only has to come down to the line, rising it goes up to the ceiling first
+	const float landY { lineY - size.y };
+	const float fall { direction.y > 0.0f ? landY - position.y : position.y + landY };
+	if (fall < 0.0f) return landing;
+
+	// Bouncing between 0 and span is a triangle wave with a period of two spans
+	const float span { GameResolution::f_Width - size.x };
+	const float unfoldedX { position.x + fall * direction.x / std::abs(direction.y) };
+	float x { unfoldedX - 2.0f * span * std::floor(unfoldedX / (2.0f * span)) };
+	if (x > span) x = 2.0f * span - x;
+
+	landing.x = x + size.x * 0.5f;
+	landing.time = fall / (std::abs(direction.y) * speed);
+	return landing;
+}
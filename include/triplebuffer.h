@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+* Hands the latest value from one writer thread to one reader thread without either ever
+* waiting. The writer fills its slot and publishes it, the reader picks up whichever slot
+* was published last, and the third slot sits between them so neither is touching the
+* other's. A reader that falls behind just skips values, a writer never blocks on a slow reader.
+
+* Slots are reused, so a T holding vectors keeps their capacity and copying into it stops
+* allocating after the first few publishes.
+*/
+template<typename T>
+class TripleBuffer
+{
+private:
+	// The middle index has this bit set when it holds a slot the reader hasn't taken yet
+	static constexpr uint8_t m_FreshBit { 4 };
+	static constexpr uint8_t m_SlotMask { 3 };
+
+	// Each slot on its own cache lines so the writer and reader don't bounce them between cores
+	struct alignas(64) Slot
+	{
+		T value {};
+	};
+
+	std::array<Slot, 3> m_Slots;
+	uint8_t m_Write { 0 };
+	alignas(64) std::atomic<uint8_t> m_Middle { 1 };
+	alignas(64) uint8_t m_Read { 2 };
+
+public:
+	// Writer thread, the slot to fill. Holds whatever was in it three publishes ago
+	inline T& GetWriteSlot()
+	{
+		return m_Slots[m_Write].value;
+	}
+
+	// Writer thread, makes the write slot the latest and takes the middle one to write next
+	inline void Publish()
+	{
+		m_Write = m_Middle.exchange(m_Write | m_FreshBit, std::memory_order_acq_rel) & m_SlotMask;
+	}
+
+	// Reader thread, swaps in the latest published slot. Returns false if nothing new was published
+	inline bool Acquire()
+	{
+		if ((m_Middle.load(std::memory_order_relaxed) & m_FreshBit) == 0) return false;
+
+		m_Read = m_Middle.exchange(m_Read, std::memory_order_acq_rel) & m_SlotMask;
+		return true;
+	}
+
+	// Reader thread, the slot from the last Acquire that returned true
+	inline const T& GetReadSlot() const
+	{
+		return m_Slots[m_Read].value;
+	}
+};
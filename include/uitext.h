@@ -0,0 +1,59 @@
+#pragma once
+#include "raylib.h"
+#include "renderqueue.h"
+#include <vector>
+
+/*
+* A piece of retained UI text. The string, its measured size and the glyph quads are
+* built once and only rebuilt when the text actually changes, so drawing it every frame
+* is just pushing the cached quads into the render queue. No MeasureTextEx, no glyph
+* lookups and no std::string per frame.
+
+* Text is stored inline (ASCII, at most m_MaxLength characters) so changing it doesn't
+* allocate either, the glyph array only grows the first time a longer string is set.
+*/
+class UIText
+{
+private:
+	static constexpr int m_MaxLength { 31 };
+
+	struct Glyph
+	{
+		Rectangle source;
+		// Relative to the text's position
+		Rectangle destination;
+	};
+
+	const Font* m_Font { nullptr };
+	float m_FontSize { 16.0f };
+	float m_Spacing { 2.0f };
+	Color m_Colour { WHITE };
+
+	char m_Text[m_MaxLength + 1] { 0 };
+	int m_Value { 0 };
+	bool m_HasValue { false };
+
+	std::vector<Glyph> m_Glyphs;
+	Vector2 m_Size { 0.0f, 0.0f };
+	Vector2 m_Position { 0.0f, 0.0f };
+	bool m_Dirty { true };
+
+	void Rebuild();
+
+public:
+	void Init(const Font& font, float fontSize, float spacing, Color colour = WHITE);
+
+	// Both return true if the text changed, i.e. anything laid out around it needs redoing
+	bool SetText(const char* text);
+	bool SetValue(int value);
+
+	// Size as MeasureTextEx would report it
+	Vector2 GetSize();
+
+	inline void SetPosition(Vector2 position)
+	{
+		m_Position = position;
+	}
+
+	void Push(RenderQueue& renderQueue, RenderLayer layer);
+};
@@ -0,0 +1,86 @@
+#include "aabbkernel.h"
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define AABB_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define AABB_KERNEL_SSE2
+#endif
+
+uint32_t OverlapMaskAABBScalar(const Rectangle& box, const float* minX, const float* minY,
+	const float* maxX, const float* maxY, size_t count)
+{
+	const float boxMaxX { box.x + box.width };
+	const float boxMaxY { box.y + box.height };
+
+	uint32_t mask { 0 };
+	for (size_t i { 0 }; i < count; i++)
+	{
+		const bool overlaps { box.x < maxX[i] && boxMaxX > minX[i] && box.y < maxY[i] && boxMaxY > minY[i] };
+		mask |= static_cast<uint32_t>(overlaps) << i;
+	}
+	return mask;
+}
+
+uint32_t OverlapMaskAABB(const Rectangle& box, const float* minX, const float* minY,
+	const float* maxX, const float* maxY, size_t count)
+{
+	uint32_t mask { 0 };
+	size_t i { 0 };
+
+#if defined(AABB_KERNEL_AVX2)
+	const __m256 boxMinX { _mm256_set1_ps(box.x) };
+	const __m256 boxMinY { _mm256_set1_ps(box.y) };
+	const __m256 boxMaxX { _mm256_set1_ps(box.x + box.width) };
+	const __m256 boxMaxY { _mm256_set1_ps(box.y + box.height) };
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256 overlapX { _mm256_and_ps(
+			_mm256_cmp_ps(boxMinX, _mm256_loadu_ps(maxX + i), _CMP_LT_OQ),
+			_mm256_cmp_ps(boxMaxX, _mm256_loadu_ps(minX + i), _CMP_GT_OQ)) };
+		const __m256 overlapY { _mm256_and_ps(
+			_mm256_cmp_ps(boxMinY, _mm256_loadu_ps(maxY + i), _CMP_LT_OQ),
+			_mm256_cmp_ps(boxMaxY, _mm256_loadu_ps(minY + i), _CMP_GT_OQ)) };
+
+		mask |= static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY))) << i;
+	}
+#elif defined(AABB_KERNEL_SSE2)
+	const __m128 boxMinX { _mm_set1_ps(box.x) };
+	const __m128 boxMinY { _mm_set1_ps(box.y) };
+	const __m128 boxMaxX { _mm_set1_ps(box.x + box.width) };
+	const __m128 boxMaxY { _mm_set1_ps(box.y + box.height) };
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128 overlapX { _mm_and_ps(
+			_mm_cmplt_ps(boxMinX, _mm_loadu_ps(maxX + i)),
+			_mm_cmpgt_ps(boxMaxX, _mm_loadu_ps(minX + i))) };
+		const __m128 overlapY { _mm_and_ps(
+			_mm_cmplt_ps(boxMinY, _mm_loadu_ps(maxY + i)),
+			_mm_cmpgt_ps(boxMaxY, _mm_loadu_ps(minY + i))) };
+
+		mask |= static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY))) << i;
+	}
+#endif
+
+	// Whatever doesn't fill a full vector
+	if (i < count)
+	{
+		mask |= OverlapMaskAABBScalar(box, minX + i, minY + i, maxX + i, maxY + i, count - i) << i;
+	}
+
+	return mask;
+}
+
+const char* OverlapMaskAABBImplementation()
+{
+#if defined(AABB_KERNEL_AVX2)
+	return "avx2";
+#elif defined(AABB_KERNEL_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
\ No newline at end of file
@@ -1,6 +1,12 @@
 #include "application.h"
+#include "assetloader.h"
 #include "raylib.h"
+#include "rlgl.h"
 #include "globals.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
 
 Application::Application()
 {
@@ -8,16 +14,48 @@ Application::Application()
 	SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_MSAA_4X_HINT);
 
 	InitWindow(GameResolution::width * 2, GameResolution::height * 2, "Breakout");
-	Image windowIcon = LoadImage("../assets/image/icon.png");
-	SetWindowIcon(windowIcon);
-	UnloadImage(windowIcon);
+	SetIcon();
 	//SetWindowState(FLAG_WINDOW_MAXIMIZED);
 	SetWindowMinSize(GameResolution::width, GameResolution::height);
 	SetTargetFPS(60);
 }
 
+/*
+* The icon comes out of assets.pak like every other image (the whole of assets/ is baked),
+* the loader only decodes the loose file if the archive isn't there. It's a single small
+* image so it's loaded right here rather than waiting on the game's loader.
+*/
+void Application::SetIcon()
+{
+	AssetLoader assets;
+	const std::string archivePath { std::string { GetApplicationDirectory() } + "assets.pak" };
+	assets.OpenArchive(archivePath.c_str());
+
+	const AssetID icon { assets.AddImage("image/icon.png") };
+	assets.Start(1);
+	assets.Wait();
+
+	// Borrowed pixels are only valid while the loader has the archive mapped, SetWindowIcon copies them
+	Image windowIcon { assets.TakeImage(icon) };
+	if (windowIcon.data != nullptr)
+	{
+		SetWindowIcon(windowIcon);
+	}
+	if (!assets.IsBorrowed(icon))
+	{
+		UnloadImage(windowIcon);
+	}
+}
+
 Application::~Application()
 {
+	// Waits for a layer that is still being constructed, everything has to go before the GL context
+	m_Transition.reset();
+	if (m_FadeTexture.id != 0)
+	{
+		UnloadTexture(m_FadeTexture);
+	}
+
 	m_layerStack.clear();
 	CloseWindow();
 }
@@ -28,19 +66,213 @@ Application& Application::Instance()
 	return instance;
 }
 
+void Application::SetFixedTimestep(float tickRate, int maxCatchUpSteps)
+{
+	m_TimestepMode = TimestepMode::FIXED;
+	m_FixedDeltaTime = 1.0f / tickRate;
+	m_MaxCatchUpSteps = maxCatchUpSteps;
+	m_Accumulator = 0.0f;
+}
+
+void Application::SetVariableTimestep()
+{
+	m_TimestepMode = TimestepMode::VARIABLE;
+	m_Accumulator = 0.0f;
+}
+
 void Application::Run()
 {
 	while (!WindowShouldClose())
 	{
+		PROFILE_FRAME();
+
+		ApplyPendingPops();
+		UpdateTransition();
 		ProcessInput();
-		float deltaTime { GetFrameTime() };
-		Update(deltaTime);
-		Draw();
+		float frameTime { GetFrameTime() };
+
+		if (m_TimestepMode == TimestepMode::VARIABLE)
+		{
+			Update(frameTime);
+			Draw(1.0f);
+			continue;
+		}
+
+		m_Accumulator += frameTime;
+
+		int steps { 0 };
+		while (m_Accumulator >= m_FixedDeltaTime && steps < m_MaxCatchUpSteps)
+		{
+			Update(m_FixedDeltaTime);
+			m_Accumulator -= m_FixedDeltaTime;
+			steps++;
+		}
+
+		// Too far behind, drop the whole ticks we couldn't fit but keep the fraction for interpolation
+		if (m_Accumulator >= m_FixedDeltaTime)
+		{
+			m_Accumulator = std::fmod(m_Accumulator, m_FixedDeltaTime);
+		}
+
+		Draw(m_Accumulator / m_FixedDeltaTime);
 	}
 }
 
+double Application::GetElapsedMilliseconds() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_StartTime).count();
+}
+
+void Application::PopLayer(const Layer* layer)
+{
+	m_PendingPops.push_back(layer);
+}
+
+void Application::ApplyPendingPops()
+{
+	for (const Layer* layer : m_PendingPops)
+	{
+		std::erase_if(m_layerStack, [&](const std::unique_ptr<Layer>& stackLayer) { return stackLayer.get() == layer; });
+
+		if (layer == m_FadeLayer)
+		{
+			m_FadeLayer = nullptr;
+		}
+	}
+	m_PendingPops.clear();
+}
+
+bool Application::BeginTransition(const Layer* fromLayer, float fadeSeconds, std::future<std::unique_ptr<Layer>> constructing)
+{
+	m_Transition = std::make_unique<Transition>();
+	m_Transition->fromLayer = fromLayer;
+	m_Transition->fadeSeconds = fadeSeconds;
+	m_Transition->constructing = std::move(constructing);
+	return true;
+}
+
+/*
+* Runs at the start of every frame. Nothing here waits: until the constructor has finished
+* there's nothing to do, after that it's one ContinueLoading a frame, so the cost to the
+* running layers is whatever the incoming layer's uploads cost spread over a few frames.
+*/
+void Application::UpdateTransition()
+{
+	if (!m_Transition) return;
+
+	PROFILE_ZONE("Application::UpdateTransition");
+	Transition& transition { *m_Transition };
+
+	if (!transition.incoming)
+	{
+		if (transition.constructing.wait_for(std::chrono::seconds { 0 }) != std::future_status::ready) return;
+		transition.incoming = transition.constructing.get();
+	}
+
+	if (transition.incoming->GetLoadProgress() < 1.0f)
+	{
+		transition.incoming->ContinueLoading();
+		return;
+	}
+
+	// A fade waits one more frame so the end of it can be captured, the last one the outgoing layer draws
+	const bool fromLayerInStack { std::any_of(m_layerStack.begin(), m_layerStack.end(),
+		[&](const std::unique_ptr<Layer>& layer) { return layer.get() == transition.fromLayer; }) };
+	if (transition.fadeSeconds > 0.0f && fromLayerInStack && !transition.fadeCaptured)
+	{
+		transition.captureFade = true;
+		return;
+	}
+
+	SwapTransition();
+}
+
+float Application::GetTransitionProgress() const
+{
+	if (!m_Transition) return 1.0f;
+	if (!m_Transition->incoming) return 0.0f;
+	return std::min(m_Transition->incoming->GetLoadProgress(), 1.0f);
+}
+
+void Application::SwapTransition()
+{
+	Transition& transition { *m_Transition };
+	const auto slot { std::find_if(m_layerStack.begin(), m_layerStack.end(),
+		[&](const std::unique_ptr<Layer>& layer) { return layer.get() == transition.fromLayer; }) };
+
+	m_FadeLayer = nullptr;
+	if (slot != m_layerStack.end() && transition.fadeCaptured)
+	{
+		m_FadeLayer = transition.incoming.get();
+		m_FadeDuration = transition.fadeSeconds;
+		m_FadeTime = 0.0f;
+	}
+	else if (m_FadeTexture.id != 0)
+	{
+		// The outgoing layer was popped after its frame was captured, there's nothing to fade from
+		UnloadTexture(m_FadeTexture);
+		m_FadeTexture = Texture2D { 0 };
+	}
+
+	if (slot != m_layerStack.end())
+	{
+		*slot = std::move(transition.incoming);
+	}
+	else
+	{
+		m_layerStack.push_back(std::move(transition.incoming));
+	}
+
+	m_Transition.reset();
+}
+
+/*
+* Reads back the framebuffer straight after the outgoing layer has drawn, so the fade has
+* it and whatever is under it but not the layers above (the profiler overlay), which would
+* otherwise show twice while it runs. The layer has finished drawing by then, so anything
+* that renders into its own texture (the BrickFieldCache) is done with it and nothing is nested.
+* A one off stall of a readback, only paid when a fade starts.
+*/
+void Application::CaptureFade()
+{
+	PROFILE_ZONE("Application::CaptureFade");
+
+	// Whatever is still in raylib's batch has to reach the framebuffer first
+	rlDrawRenderBatchActive();
+	Image frame { LoadImageFromScreen() };
+
+	// A fade still running is in the capture, so it can stop here
+	if (m_FadeTexture.id != 0) UnloadTexture(m_FadeTexture);
+	m_FadeTexture = LoadTextureFromImage(frame);
+	m_FadeLayer = nullptr;
+	UnloadImage(frame);
+
+	m_Transition->captureFade = false;
+	m_Transition->fadeCaptured = true;
+}
+
+void Application::DrawFade(float frameTime)
+{
+	m_FadeTime += frameTime;
+	const float alpha { 1.0f - m_FadeTime / m_FadeDuration };
+	if (alpha <= 0.0f)
+	{
+		UnloadTexture(m_FadeTexture);
+		m_FadeTexture = Texture2D { 0 };
+		m_FadeLayer = nullptr;
+		return;
+	}
+
+	// The window may have been resized since, and with high DPI the capture is in render pixels
+	const Texture2D& texture { m_FadeTexture };
+	const Rectangle source { 0.0f, 0.0f, static_cast<float>(texture.width), static_cast<float>(texture.height) };
+	const Rectangle destination { 0.0f, 0.0f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight()) };
+	DrawTexturePro(texture, source, destination, { 0.0f, 0.0f }, 0.0f, Fade(WHITE, alpha));
+}
+
 void Application::ProcessInput()
 {
+	PROFILE_ZONE("Application::ProcessInput");
 	for (auto iter { m_layerStack.rbegin() }; iter != m_layerStack.rend(); ++iter)
 	{
 		if ((*iter)->ProcessInput())
@@ -52,19 +284,46 @@ void Application::ProcessInput()
 
 void Application::Update(float deltaTime)
 {
+	PROFILE_ZONE("Application::Update");
 	for (const std::unique_ptr<Layer>& layer : m_layerStack)
 	{
 		layer->Update(deltaTime);
 	}
 }
 
-void Application::Draw()
+void Application::Draw(float interpolationAlpha)
 {
-	BeginDrawing();
-	for (const std::unique_ptr<Layer>& layer : m_layerStack)
 	{
-		layer->Draw();
+		PROFILE_ZONE("Application::Draw");
+		BeginDrawing();
+		for (const std::unique_ptr<Layer>& layer : m_layerStack)
+		{
+			layer->Draw(interpolationAlpha);
+
+			// Layers above the one that was transitioned in are drawn over the fade
+			if (layer.get() == m_FadeLayer)
+			{
+				DrawFade(GetFrameTime());
+			}
+
+			// Before the layers above it draw, they carry on live over the fade
+			if (m_Transition && m_Transition->captureFade && layer.get() == m_Transition->fromLayer)
+			{
+				CaptureFade();
+			}
+		}
+	}
+
+	// Flushes the last batch, swaps and waits out the rest of the frame for SetTargetFPS
+	{
+		PROFILE_ZONE("EndDrawing");
+		EndDrawing();
+	}
+
+	if (!m_FirstFrameDrawn)
+	{
+		m_FirstFrameDrawn = true;
+		TraceLog(LOG_INFO, "APP: First frame presented after %.1f ms", GetElapsedMilliseconds());
 	}
-	EndDrawing();
 }
 
@@ -0,0 +1,328 @@
+#include "assetloader.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstring>
+
+AssetLoader::~AssetLoader()
+{
+	// Let the workers finish whatever they are on before freeing anything
+	m_NextJob.store(m_Jobs.size());
+	m_Workers.clear();
+
+	for (size_t i { 0 }; i < m_Jobs.size(); i++)
+	{
+		Job& job { m_Jobs[i] };
+		if (job.taken || !IsReady(static_cast<AssetID>(i))) continue;
+
+		switch (job.type)
+		{
+		case AssetType::IMAGE:
+			if (!job.borrowed) UnloadImage(job.image);
+			break;
+		case AssetType::WAVE:
+			if (!job.borrowed) UnloadWave(job.wave);
+			break;
+		case AssetType::FONT:
+			if (!job.borrowed) UnloadImage(job.image);
+			UnloadFontData(job.font.glyphs, job.font.glyphCount);
+			MemFree(job.font.recs);
+			break;
+		case AssetType::AUDIO_DEVICE:
+			break;
+		}
+	}
+}
+
+AssetID AssetLoader::Add(const Job& job)
+{
+	m_Jobs.push_back(job);
+	return static_cast<AssetID>(m_Jobs.size() - 1);
+}
+
+/*
+* How many bytes an entry's data has to be for what its fields say it holds, 0 when the
+* fields don't make sense. raylib reads the data straight out of the mapping, so this is
+* the only thing stopping a truncated or mismatched archive sending it off the end.
+* The limits are far past anything the baker writes, they keep the sums from overflowing.
+*/
+static uint64_t ExpectedEntrySize(const ArchiveEntry& entry)
+{
+	auto PixelBytes { [](int32_t width, int32_t height, int32_t format) -> uint64_t {
+		// Only uncompressed formats, where every pixel is a whole number of bytes
+		constexpr int32_t maxDimension { 1 << 16 };
+		if (width <= 0 || height <= 0 || width > maxDimension || height > maxDimension) return 0;
+		if (format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE || format > PIXELFORMAT_UNCOMPRESSED_R16G16B16A16) return 0;
+		return static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * static_cast<uint64_t>(GetPixelDataSize(1, 1, format));
+		} };
+
+	switch (entry.type)
+	{
+	case ARCHIVE_ENTRY_IMAGE:
+		return PixelBytes(entry.width, entry.height, entry.format);
+	case ARCHIVE_ENTRY_WAVE:
+		if (entry.frameCount == 0 || entry.channels == 0 || entry.channels > 8) return 0;
+		if (entry.sampleSize != 8 && entry.sampleSize != 16 && entry.sampleSize != 32) return 0;
+		return static_cast<uint64_t>(entry.frameCount) * entry.channels * (entry.sampleSize / 8);
+	case ARCHIVE_ENTRY_FONT:
+	{
+		const uint64_t atlasBytes { PixelBytes(entry.width, entry.height, entry.format) };
+		if (entry.glyphCount <= 0 || atlasBytes == 0) return 0;
+		return static_cast<uint64_t>(entry.glyphCount) * sizeof(ArchiveGlyph) + atlasBytes;
+	}
+	}
+	return 0;
+}
+
+bool AssetLoader::OpenArchive(const char* path)
+{
+	if (!m_Archive.Open(path)) return false;
+
+	const uint8_t* data { m_Archive.GetData() };
+	const size_t size { m_Archive.GetSize() };
+
+	ArchiveHeader header;
+	bool valid { size >= sizeof(header) };
+	if (valid)
+	{
+		std::memcpy(&header, data, sizeof(header));
+		valid = header.magic == ArchiveMagic && header.version == ArchiveVersion &&
+			sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(ArchiveEntry) <= size;
+	}
+
+	if (valid)
+	{
+		m_ArchiveEntries = reinterpret_cast<const ArchiveEntry*>(data + sizeof(header));
+		m_ArchiveEntryCount = header.entryCount;
+		for (uint32_t i { 0 }; i < m_ArchiveEntryCount && valid; i++)
+		{
+			// Inside the file, aligned the way the baker writes it and exactly as big as its fields say
+			const ArchiveEntry& entry { m_ArchiveEntries[i] };
+			const uint64_t expectedSize { ExpectedEntrySize(entry) };
+			valid = entry.offset % ArchiveAlignment == 0 && entry.size <= size && entry.offset <= size - entry.size &&
+				expectedSize != 0 && expectedSize == entry.size;
+
+			if (!valid)
+			{
+				TraceLog(LOG_WARNING, "ASSETS: [%s] Entry %.*s doesn't match its data", path, static_cast<int>(sizeof(entry.name)), entry.name);
+			}
+		}
+	}
+
+	if (!valid)
+	{
+		TraceLog(LOG_WARNING, "ASSETS: [%s] Not a valid archive for this build, loading loose files", path);
+		m_ArchiveEntries = nullptr;
+		m_ArchiveEntryCount = 0;
+		m_Archive.Close();
+		return false;
+	}
+
+	TraceLog(LOG_INFO, "ASSETS: [%s] Mapped archive with %u assets", path, m_ArchiveEntryCount);
+	return true;
+}
+
+const ArchiveEntry* AssetLoader::FindArchiveEntry(const std::string& name, ArchiveEntryType type) const
+{
+	for (uint32_t i { 0 }; i < m_ArchiveEntryCount; i++)
+	{
+		const ArchiveEntry& entry { m_ArchiveEntries[i] };
+		if (entry.type == type && name == entry.name) return &entry;
+	}
+	return nullptr;
+}
+
+/*
+* Nothing to decode, the job's data just points into the mapped archive. Only the font
+* needs a little work since raylib wants its own glyph and rect arrays.
+*/
+bool AssetLoader::LoadFromArchive(Job& job)
+{
+	void* base { const_cast<uint8_t*>(m_Archive.GetData()) };
+
+	switch (job.type)
+	{
+	case AssetType::IMAGE:
+	{
+		const ArchiveEntry* entry { FindArchiveEntry(job.path, ARCHIVE_ENTRY_IMAGE) };
+		if (entry == nullptr) return false;
+
+		job.image = Image { static_cast<uint8_t*>(base) + entry->offset, entry->width, entry->height, 1, entry->format };
+		break;
+	}
+	case AssetType::WAVE:
+	{
+		const ArchiveEntry* entry { FindArchiveEntry(job.path, ARCHIVE_ENTRY_WAVE) };
+		if (entry == nullptr) return false;
+
+		job.wave = Wave { entry->frameCount, entry->sampleRate, entry->sampleSize, entry->channels, static_cast<uint8_t*>(base) + entry->offset };
+		break;
+	}
+	case AssetType::FONT:
+	{
+		// Baked at one size, anything else has to be rasterised from the TTF
+		const ArchiveEntry* entry { FindArchiveEntry(job.path, ARCHIVE_ENTRY_FONT) };
+		if (entry == nullptr || entry->fontSize != job.fontSize || entry->glyphCount != job.glyphCount) return false;
+
+		const ArchiveGlyph* glyphs { reinterpret_cast<const ArchiveGlyph*>(static_cast<uint8_t*>(base) + entry->offset) };
+		job.font.baseSize = entry->fontSize;
+		job.font.glyphCount = entry->glyphCount;
+		job.font.glyphPadding = entry->glyphPadding;
+		job.font.glyphs = static_cast<GlyphInfo*>(MemAlloc(static_cast<unsigned int>(entry->glyphCount * sizeof(GlyphInfo))));
+		job.font.recs = static_cast<Rectangle*>(MemAlloc(static_cast<unsigned int>(entry->glyphCount * sizeof(Rectangle))));
+		for (int i { 0 }; i < entry->glyphCount; i++)
+		{
+			job.font.glyphs[i] = GlyphInfo { glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX, Image { 0 } };
+			job.font.recs[i] = Rectangle { glyphs[i].recX, glyphs[i].recY, glyphs[i].recWidth, glyphs[i].recHeight };
+		}
+
+		job.image = Image { const_cast<ArchiveGlyph*>(glyphs + entry->glyphCount), entry->width, entry->height, 1, entry->format };
+		break;
+	}
+	case AssetType::AUDIO_DEVICE:
+		return false;
+	}
+
+	job.borrowed = true;
+	return true;
+}
+
+AssetID AssetLoader::AddImage(const char* name)
+{
+	Job job;
+	job.type = AssetType::IMAGE;
+	job.path = name;
+	return Add(job);
+}
+
+AssetID AssetLoader::AddWave(const char* name)
+{
+	Job job;
+	job.type = AssetType::WAVE;
+	job.path = name;
+	return Add(job);
+}
+
+AssetID AssetLoader::AddFont(const char* name, int fontSize, int glyphCount)
+{
+	Job job;
+	job.type = AssetType::FONT;
+	job.path = name;
+	job.fontSize = fontSize;
+	job.glyphCount = glyphCount;
+	return Add(job);
+}
+
+AssetID AssetLoader::AddAudioDevice()
+{
+	Job job;
+	job.type = AssetType::AUDIO_DEVICE;
+	return Add(job);
+}
+
+void AssetLoader::Start(unsigned int maxWorkers)
+{
+	m_Ready = std::make_unique<std::atomic<bool>[]>(m_Jobs.size());
+
+	// Whatever is in the archive is ready straight away, the workers skip it
+	size_t jobsLeft { m_Jobs.size() };
+	for (size_t i { 0 }; i < m_Jobs.size() && m_Archive.IsOpen(); i++)
+	{
+		if (LoadFromArchive(m_Jobs[i]))
+		{
+			m_Ready[i].store(true, std::memory_order_release);
+			m_ReadyCount.fetch_add(1, std::memory_order_relaxed);
+			jobsLeft--;
+		}
+	}
+
+	const unsigned int hardwareThreads { std::max(1u, std::thread::hardware_concurrency()) };
+	const size_t workers { std::min<size_t>({ maxWorkers, hardwareThreads, jobsLeft }) };
+	for (size_t i { 0 }; i < workers; i++)
+	{
+		m_Workers.emplace_back([this] { RunJobs(); });
+	}
+}
+
+void AssetLoader::Wait()
+{
+	// jthread joins on destruction
+	m_Workers.clear();
+}
+
+void AssetLoader::RunJobs()
+{
+	PROFILE_THREAD("asset worker");
+
+	for (size_t i { m_NextJob.fetch_add(1) }; i < m_Jobs.size(); i = m_NextJob.fetch_add(1))
+	{
+		if (m_Ready[i].load(std::memory_order_relaxed)) continue;
+
+		RunJob(m_Jobs[i]);
+		m_Ready[i].store(true, std::memory_order_release);
+		m_ReadyCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void AssetLoader::RunJob(Job& job)
+{
+	PROFILE_ZONE("AssetLoader::RunJob");
+
+	switch (job.type)
+	{
+	case AssetType::IMAGE:
+	{
+		job.image = LoadImage((m_LooseRoot + job.path).c_str());
+		break;
+	}
+	case AssetType::WAVE:
+	{
+		job.wave = LoadWave((m_LooseRoot + job.path).c_str());
+		break;
+	}
+	case AssetType::FONT:
+	{
+		// The CPU half of LoadFontFromMemory, raylib pads TTF glyphs by 4px
+		constexpr int glyphPadding { 4 };
+
+		int dataSize { 0 };
+		unsigned char* fileData { LoadFileData((m_LooseRoot + job.path).c_str(), &dataSize) };
+		if (fileData == nullptr) break;
+
+		job.font.baseSize = job.fontSize;
+		job.font.glyphCount = job.glyphCount;
+		job.font.glyphPadding = glyphPadding;
+		job.font.glyphs = LoadFontData(fileData, dataSize, job.fontSize, nullptr, job.glyphCount, FONT_DEFAULT);
+		UnloadFileData(fileData);
+
+		if (job.font.glyphs != nullptr)
+		{
+			job.image = GenImageFontAtlas(job.font.glyphs, &job.font.recs, job.glyphCount, job.fontSize, glyphPadding, 0);
+		}
+		break;
+	}
+	case AssetType::AUDIO_DEVICE:
+	{
+		InitAudioDevice();
+		break;
+	}
+	}
+}
+
+Image AssetLoader::TakeImage(AssetID asset)
+{
+	m_Jobs[asset].taken = true;
+	return m_Jobs[asset].image;
+}
+
+Wave AssetLoader::TakeWave(AssetID asset)
+{
+	m_Jobs[asset].taken = true;
+	return m_Jobs[asset].wave;
+}
+
+Font AssetLoader::TakeFont(AssetID asset, Image& atlas)
+{
+	m_Jobs[asset].taken = true;
+	atlas = m_Jobs[asset].image;
+	return m_Jobs[asset].font;
+}
@@ -0,0 +1,111 @@
+#include "audio.h"
+#include <algorithm>
+
+namespace Audio
+{
+	VariantID NullBackend::CreateVariant(const Wave& wave, float pitch)
+	{
+		// Resampled to play back at the pitch, so a higher pitch is a shorter sound
+		const double length { wave.sampleRate > 0 ? static_cast<double>(wave.frameCount) / wave.sampleRate : 0.0 };
+		m_VariantLengths.push_back(length / pitch);
+		return static_cast<VariantID>(m_VariantLengths.size() - 1);
+	}
+
+	VoiceID NullBackend::CreateVoice(VariantID firstVariant, uint32_t)
+	{
+		m_Voices.push_back(Voice { firstVariant, 0.0 });
+		return static_cast<VoiceID>(m_Voices.size() - 1);
+	}
+
+	void NullBackend::Play(VoiceID voice, uint32_t variant)
+	{
+		m_Voices[voice].endTime = m_Time + m_VariantLengths[m_Voices[voice].firstVariant + variant];
+	}
+
+	void NullBackend::Stop(VoiceID voice)
+	{
+		m_Voices[voice].endTime = m_Time;
+	}
+
+	bool NullBackend::IsPlaying(VoiceID voice) const
+	{
+		return m_Time < m_Voices[voice].endTime;
+	}
+
+	VoicePool::VoicePool(Backend& backend)
+		: m_Backend { backend }
+	{
+	}
+
+	EffectID VoicePool::AddEffect(const Wave& wave, std::span<const float> pitches, uint32_t voiceCount)
+	{
+		static constexpr float unpitched[] { 1.0f };
+		if (pitches.empty()) pitches = unpitched;
+
+		VariantID firstVariant { 0 };
+		for (size_t i { 0 }; i < pitches.size(); i++)
+		{
+			const VariantID variant { m_Backend.CreateVariant(wave, pitches[i]) };
+			if (i == 0) firstVariant = variant;
+		}
+
+		Effect effect { 0, voiceCount, static_cast<uint32_t>(pitches.size()) };
+		for (uint32_t i { 0 }; i < voiceCount; i++)
+		{
+			const VoiceID voice { m_Backend.CreateVoice(firstVariant, effect.variantCount) };
+			if (i == 0) effect.firstVoice = voice;
+			m_VoiceStarted.resize(std::max<size_t>(m_VoiceStarted.size(), voice + 1), 0);
+		}
+
+		m_Effects.push_back(effect);
+		return static_cast<EffectID>(m_Effects.size() - 1);
+	}
+
+	void VoicePool::Play(EffectID effect)
+	{
+		const uint32_t variantCount { m_Effects[effect].variantCount };
+		PlayVariant(effect, variantCount > 1 ? m_Random.Next() % variantCount : 0);
+	}
+
+	void VoicePool::PlayVariant(EffectID effect, uint32_t variant)
+	{
+		const Effect& info { m_Effects[effect] };
+		if (info.voiceCount == 0 || variant >= info.variantCount) return;
+
+		// First idle voice, otherwise the one that has been playing the longest
+		VoiceID chosen { info.firstVoice };
+		bool idle { false };
+		for (VoiceID voice { info.firstVoice }; voice < info.firstVoice + info.voiceCount; voice++)
+		{
+			if (!m_Backend.IsPlaying(voice))
+			{
+				chosen = voice;
+				idle = true;
+				break;
+			}
+
+			if (m_VoiceStarted[voice] < m_VoiceStarted[chosen]) chosen = voice;
+		}
+
+		if (!idle)
+		{
+			m_Backend.Stop(chosen);
+			m_Stats.steals++;
+		}
+
+		m_Stats.plays++;
+		m_VoiceStarted[chosen] = m_Stats.plays;
+		m_Backend.Play(chosen, variant);
+	}
+
+	void VoicePool::StopAll()
+	{
+		for (const Effect& effect : m_Effects)
+		{
+			for (VoiceID voice { effect.firstVoice }; voice < effect.firstVoice + effect.voiceCount; voice++)
+			{
+				m_Backend.Stop(voice);
+			}
+		}
+	}
+};
@@ -0,0 +1,72 @@
+#include "autoplayer.h"
+#include "trajectory.h"
+#include <cmath>
+
+SimInput Autoplayer::NextInput(const GameState& gameState)
+{
+	SimInput input;
+	input.confirm = gameState.m_GameMode == GameMode::PAUSED || gameState.m_GameMode == GameMode::GAME_OVER;
+
+	// Multi-ball, top the round up to the requested ball count once it starts
+	if (gameState.m_GameMode != GameMode::PLAYING)
+	{
+		ballsSpawned = false;
+	}
+	else if (!ballsSpawned)
+	{
+		input.spawnBalls = numBalls - 1;
+		ballsSpawned = true;
+	}
+
+	const EntityStore& entities { gameState.m_Entities };
+	if (entities.Count<MovableBalls>() == 0) return input;
+
+	const size_t paddle { gameState.m_Paddle };
+	const float paddleCenterX { entities.positions[paddle].x + entities.sizes[paddle].x * 0.5f };
+	float targetX { paddleCenterX };
+
+	if (aim == AutoplayAim::LOWEST_BALL)
+	{
+		// Chase the lowest active ball
+		size_t chasedBall { entities.Indices<MovableBalls>().front() };
+		entities.Each<MovableBalls>([&](size_t ball) {
+			if (entities.positions[ball].y > entities.positions[chasedBall].y)
+			{
+				chasedBall = ball;
+			}
+			});
+
+		targetX = entities.positions[chasedBall].x + entities.sizes[chasedBall].x * 0.5f;
+	}
+	else
+	{
+		// The soonest ball to land that the paddle can still get to, or just the soonest if it can't make any
+		const float halfPaddleWidth { entities.sizes[paddle].x * 0.5f };
+		const float paddleSpeed { entities.moveSpeeds[paddle] };
+		const float lineY { entities.positions[paddle].y };
+		BallLanding target;
+		bool targetReachable { false };
+
+		entities.Each<MovableBalls>([&](size_t ball) {
+			const BallLanding landing { PredictLanding(entities.positions[ball], entities.sizes[ball], entities.directions[ball], entities.moveSpeeds[ball], lineY) };
+			const bool reachable { std::abs(landing.x - paddleCenterX) - halfPaddleWidth <= paddleSpeed * landing.time };
+			if ((reachable && !targetReachable) || (reachable == targetReachable && landing.time < target.time))
+			{
+				target = landing;
+				targetReachable = reachable;
+			}
+			});
+
+		if (std::isinf(target.time)) return input;
+
+		// Caught dead centre the ball goes straight back up and can bounce between the paddle and the
+		// ceiling forever, so take it well off centre to send it back over towards the middle
+		const float offCentre { halfPaddleWidth * 0.8f };
+		targetX = target.x < GameResolution::f_Width * 0.5f ? target.x - offCentre : target.x + offCentre;
+	}
+
+	if (targetX < paddleCenterX - 4.0f) input.paddleDirection = -1.0f;
+	if (targetX > paddleCenterX + 4.0f) input.paddleDirection = 1.0f;
+
+	return input;
+}
@@ -0,0 +1,201 @@
+#include "batchsimulation.h"
+#include "globals.h"
+#include "profiler.h"
+#include <algorithm>
+
+BatchSimulation::BatchSimulation(size_t count, unsigned int threads, float tickRate, const SimLayout& layout)
+	: m_Count { count }, m_Environments { std::make_unique<Environment[]>(count) }, m_Layout { layout }, m_TickLength { 1.0f / tickRate }
+{
+	m_Observations.resize(count * m_ObservationSize);
+	m_Rewards.resize(count);
+	m_Dones.resize(count);
+
+	if (threads == 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = static_cast<unsigned int>(std::clamp<size_t>(threads, 1, std::max<size_t>(count, 1)));
+
+	// A few chunks per thread so one running slow (lots of balls in its games) doesn't hold up the rest
+	m_ChunkSize = std::max<size_t>(1, count / (threads * 8));
+
+	for (unsigned int i { 1 }; i < threads; i++)
+	{
+		m_Workers.emplace_back([this] { WorkerLoop(); });
+	}
+
+	Reset(0);
+}
+
+BatchSimulation::~BatchSimulation()
+{
+	m_Stopping.store(true, std::memory_order_relaxed);
+	m_JobGeneration.fetch_add(1, std::memory_order_release);
+	m_JobGeneration.notify_all();
+	m_Workers.clear();
+}
+
+void BatchSimulation::SetLevel(const BrickField& level)
+{
+	for (size_t i { 0 }; i < m_Count; i++)
+	{
+		m_Environments[i].simulation.SetLevel(level);
+	}
+}
+
+void BatchSimulation::Reset(uint32_t seed)
+{
+	m_Seed = seed;
+	Run(Job::RESET);
+}
+
+void BatchSimulation::Step(std::span<const float> actions)
+{
+	PROFILE_ZONE("BatchSimulation::Step");
+	m_Actions = actions.data();
+	Run(Job::STEP);
+}
+
+void BatchSimulation::Run(Job job)
+{
+	m_Job = job;
+	m_Remaining.store(m_Count, std::memory_order_relaxed);
+	m_NextEnvironment.store(0, std::memory_order_release);
+
+	m_JobGeneration.fetch_add(1, std::memory_order_release);
+	m_JobGeneration.notify_all();
+
+	RunChunks();
+
+	// The last chunk to finish wakes us, the workers' writes to the arrays are visible after
+	for (size_t remaining { m_Remaining.load(std::memory_order_acquire) }; remaining != 0; remaining = m_Remaining.load(std::memory_order_acquire))
+	{
+		m_Remaining.wait(remaining, std::memory_order_acquire);
+	}
+}
+
+void BatchSimulation::WorkerLoop()
+{
+	PROFILE_THREAD("batch worker");
+
+	uint32_t generation { 0 };
+	while (true)
+	{
+		m_JobGeneration.wait(generation, std::memory_order_acquire);
+		generation = m_JobGeneration.load(std::memory_order_acquire);
+		if (m_Stopping.load(std::memory_order_relaxed)) return;
+
+		RunChunks();
+	}
+}
+
+void BatchSimulation::RunChunks()
+{
+	for (size_t first { m_NextEnvironment.fetch_add(m_ChunkSize, std::memory_order_acq_rel) }; first < m_Count;
+		first = m_NextEnvironment.fetch_add(m_ChunkSize, std::memory_order_acq_rel))
+	{
+		const size_t last { std::min(first + m_ChunkSize, m_Count) };
+		for (size_t i { first }; i < last; i++)
+		{
+			if (m_Job == Job::STEP)
+			{
+				StepEnvironment(i);
+			}
+			else
+			{
+				ResetEnvironment(i);
+			}
+			WriteObservation(i);
+		}
+
+		if (m_Remaining.fetch_sub(last - first, std::memory_order_acq_rel) == last - first)
+		{
+			m_Remaining.notify_all();
+		}
+	}
+}
+
+void BatchSimulation::ResetEnvironment(size_t index)
+{
+	Environment& environment { m_Environments[index] };
+	environment.simulation.Init(m_Layout, m_Seed + static_cast<uint32_t>(index));
+	environment.lastScore = 0;
+	m_Rewards[index] = 0.0f;
+	m_Dones[index] = 0;
+}
+
+void BatchSimulation::StepEnvironment(size_t index)
+{
+	Environment& environment { m_Environments[index] };
+	GameState& state { environment.state };
+
+	SimInput input;
+	input.paddleDirection = std::clamp(m_Actions[index], -1.0f, 1.0f);
+	input.confirm = state.m_GameMode == GameMode::PAUSED;
+
+	const uint8_t events { environment.simulation.Step(input, m_TickLength) };
+	float reward { static_cast<float>(state.m_Score - environment.lastScore) / m_PointsPerReward };
+
+	m_Dones[index] = (events & EVENT_GAME_OVER) != 0;
+	if (m_Dones[index])
+	{
+		// Straight on to the next game, the high score carries over like it does for a player
+		reward -= 1.0f;
+		environment.simulation.ResetGame();
+		state.m_GameMode = GameMode::PAUSED;
+	}
+
+	environment.lastScore = state.m_Score;
+	m_Rewards[index] = reward;
+}
+
+void BatchSimulation::WriteObservation(size_t index)
+{
+	const GameState& state { m_Environments[index].state };
+	const EntityStore& entities { state.m_Entities };
+	float* observation { &m_Observations[index * m_ObservationSize] };
+
+	const size_t paddle { state.m_Paddle };
+	observation[0] = (entities.positions[paddle].x + entities.sizes[paddle].x * 0.5f) / GameResolution::f_Width;
+
+	const BrickField& bricks { state.m_Bricks };
+	const size_t cells { static_cast<size_t>(bricks.GetColumns()) * bricks.GetRows() };
+	observation[1] = cells == 0 ? 0.0f : static_cast<float>(bricks.GetLiveCount()) / static_cast<float>(cells);
+	observation[2] = static_cast<float>(entities.Count<MovableBalls>());
+
+	// The lowest balls are the ones about to matter, kept in a tiny sorted array as they go past
+	uint32_t lowest[m_ObservedBalls];
+	size_t lowestCount { 0 };
+	entities.Each<MovableBalls>([&](size_t ball) {
+		const float y { entities.positions[ball].y };
+		size_t slot { lowestCount };
+		while (slot > 0 && entities.positions[lowest[slot - 1]].y < y)
+		{
+			if (slot < m_ObservedBalls) lowest[slot] = lowest[slot - 1];
+			slot--;
+		}
+
+		if (slot < m_ObservedBalls)
+		{
+			lowest[slot] = static_cast<uint32_t>(ball);
+			lowestCount = std::min(lowestCount + 1, m_ObservedBalls);
+		}
+		});
+
+	float* ballObservation { observation + 3 };
+	for (size_t i { 0 }; i < m_ObservedBalls; i++, ballObservation += m_BallObservationSize)
+	{
+		if (i >= lowestCount)
+		{
+			std::fill_n(ballObservation, m_BallObservationSize, 0.0f);
+			continue;
+		}
+
+		const uint32_t ball { lowest[i] };
+		ballObservation[0] = (entities.positions[ball].x + entities.sizes[ball].x * 0.5f) / GameResolution::f_Width;
+		ballObservation[1] = (entities.positions[ball].y + entities.sizes[ball].y * 0.5f) / GameResolution::f_Height;
+		ballObservation[2] = entities.directions[ball].x;
+		ballObservation[3] = entities.directions[ball].y;
+		ballObservation[4] = 1.0f;
+	}
+}
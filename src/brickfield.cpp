@@ -0,0 +1,225 @@
+#include "brickfield.h"
+#include <cstring>
+
+void BrickField::Reset(int columns, int rows)
+{
+	m_Columns = std::max(0, columns);
+	m_Rows = std::max(0, rows);
+	m_ChunkColumns = (m_Columns + m_ChunkSize - 1) >> m_ChunkShift;
+	m_ChunkRows = (m_Rows + m_ChunkSize - 1) >> m_ChunkShift;
+	m_Directory.assign(static_cast<size_t>(m_ChunkColumns) * m_ChunkRows, m_NoChunk);
+	m_Chunks.clear();
+	m_FreeChunks.clear();
+	m_LiveCount = 0;
+	m_OffsetY = 0.0f;
+	m_PreviousOffsetY = 0.0f;
+	m_Revision++;
+	m_Generation++;
+}
+
+void BrickField::Clear()
+{
+	std::fill(m_Directory.begin(), m_Directory.end(), m_NoChunk);
+	m_Chunks.clear();
+	m_FreeChunks.clear();
+	m_LiveCount = 0;
+	m_Revision++;
+	m_Generation++;
+}
+
+void BrickField::CopyFrom(const BrickField& other)
+{
+	const uint32_t revision { m_Revision };
+	const uint32_t generation { m_Generation };
+	*this = other;
+	m_Revision = revision + 1;
+	m_Generation = generation + 1;
+}
+
+void BrickField::SetLayout(Vector2 origin, Vector2 pitch, Vector2 brickSize)
+{
+	m_Origin = origin;
+	m_Pitch = pitch;
+	m_BrickSize = brickSize;
+	m_Revision++;
+	m_Generation++;
+}
+
+int32_t BrickField::AllocateChunk()
+{
+	if (!m_FreeChunks.empty())
+	{
+		const int32_t chunk { m_FreeChunks.back() };
+		m_FreeChunks.pop_back();
+		return chunk;
+	}
+
+	m_Chunks.emplace_back();
+	return static_cast<int32_t>(m_Chunks.size() - 1);
+}
+
+void BrickField::FreeChunk(int32_t chunk)
+{
+	// Only the mask says what's live, the cell bytes are overwritten as bricks are added again
+	m_Chunks[chunk].live = 0;
+	m_FreeChunks.push_back(chunk);
+}
+
+void BrickField::Set(int column, int row, BrickCell cell)
+{
+	if (!InBounds(column, row)) return;
+
+	if (cell.hitPoints == 0)
+	{
+		Remove(column, row);
+		return;
+	}
+
+	int32_t& slot { DirectorySlot(column, row) };
+	if (slot == m_NoChunk)
+	{
+		slot = AllocateChunk();
+	}
+
+	Chunk& chunk { m_Chunks[slot] };
+	const int bit { BitOf(column, row) };
+	if ((chunk.live >> bit & 1) == 0)
+	{
+		chunk.live |= uint64_t { 1 } << bit;
+		m_LiveCount++;
+	}
+	else
+	{
+		m_Generation++;
+	}
+	m_Revision++;
+	const uint8_t type { std::min<uint8_t>(cell.type, BrickTypeCount - 1) };
+	const uint8_t hitPoints { std::min<uint8_t>(cell.hitPoints, MaxBrickHitPoints) };
+	chunk.cells[bit] = static_cast<uint8_t>(type << 4 | hitPoints);
+}
+
+void BrickField::Fill(int firstColumn, int firstRow, int columns, int rows, BrickCell cell)
+{
+	const int lastColumn { std::min(m_Columns, firstColumn + columns) - 1 };
+	const int lastRow { std::min(m_Rows, firstRow + rows) - 1 };
+	firstColumn = std::max(0, firstColumn);
+	firstRow = std::max(0, firstRow);
+	if (firstColumn > lastColumn || firstRow > lastRow || cell.hitPoints == 0) return;
+
+	const uint8_t type { std::min<uint8_t>(cell.type, BrickTypeCount - 1) };
+	const uint8_t hitPoints { std::min<uint8_t>(cell.hitPoints, MaxBrickHitPoints) };
+	const uint8_t packed { static_cast<uint8_t>(type << 4 | hitPoints) };
+
+	for (int chunkRow { firstRow >> m_ChunkShift }; chunkRow <= (lastRow >> m_ChunkShift); chunkRow++)
+	{
+		const int rowStart { chunkRow << m_ChunkShift };
+		const int rowFirst { std::max(firstRow, rowStart) - rowStart };
+		const int rowLast { std::min(lastRow, rowStart + m_ChunkSize - 1) - rowStart };
+
+		// A byte of the mask is a row of the chunk, so a 0x01 in each row's byte spreads a column span down the rows
+		const uint64_t rowBytes { (~uint64_t { 0 } >> ((m_ChunkSize - 1 - rowLast + rowFirst) << m_ChunkShift)) / 0xFF << (rowFirst << m_ChunkShift) };
+
+		for (int chunkColumn { firstColumn >> m_ChunkShift }; chunkColumn <= (lastColumn >> m_ChunkShift); chunkColumn++)
+		{
+			const int columnStart { chunkColumn << m_ChunkShift };
+			const int columnFirst { std::max(firstColumn, columnStart) - columnStart };
+			const int columnLast { std::min(lastColumn, columnStart + m_ChunkSize - 1) - columnStart };
+			const uint64_t columnBits { (0xFFu << columnFirst) & (0xFFu >> (m_ChunkSize - 1 - columnLast)) };
+			const uint64_t mask { rowBytes * columnBits };
+
+			int32_t& slot { m_Directory[static_cast<size_t>(chunkRow) * m_ChunkColumns + chunkColumn] };
+			if (slot == m_NoChunk)
+			{
+				slot = AllocateChunk();
+			}
+
+			Chunk& chunk { m_Chunks[slot] };
+			if ((chunk.live & mask) != 0) m_Generation++;
+			m_LiveCount += static_cast<size_t>(std::popcount(mask & ~chunk.live));
+			chunk.live |= mask;
+
+			for (int row { rowFirst }; row <= rowLast; row++)
+			{
+				std::memset(&chunk.cells[(row << m_ChunkShift) + columnFirst], packed, static_cast<size_t>(columnLast - columnFirst + 1));
+			}
+		}
+	}
+	m_Revision++;
+}
+
+void BrickField::Remove(int column, int row)
+{
+	if (!InBounds(column, row)) return;
+
+	int32_t& slot { DirectorySlot(column, row) };
+	if (slot == m_NoChunk) return;
+
+	Chunk& chunk { m_Chunks[slot] };
+	const int bit { BitOf(column, row) };
+	if ((chunk.live >> bit & 1) == 0) return;
+
+	chunk.live &= ~(uint64_t { 1 } << bit);
+	m_LiveCount--;
+	m_Revision++;
+
+	if (chunk.live == 0)
+	{
+		FreeChunk(slot);
+		slot = m_NoChunk;
+	}
+}
+
+bool BrickField::Hit(int column, int row)
+{
+	if (!IsLive(column, row)) return false;
+
+	// The hit points are the low nibble
+	uint8_t& cell { m_Chunks[DirectorySlot(column, row)].cells[BitOf(column, row)] };
+	if ((cell & 0x0F) > 1)
+	{
+		cell--;
+		m_Revision++;
+		return false;
+	}
+
+	Remove(column, row);
+	return true;
+}
+
+BrickCell BrickField::Get(int column, int row) const
+{
+	if (!IsLive(column, row)) return BrickCell {};
+
+	return Unpack(m_Chunks[DirectorySlot(column, row)].cells[BitOf(column, row)]);
+}
+
+size_t BrickField::GetChunkCount() const
+{
+	return m_Chunks.size() - m_FreeChunks.size();
+}
+
+size_t BrickField::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_Directory.capacity() * sizeof(int32_t) + m_Chunks.capacity() * sizeof(Chunk) +
+		m_FreeChunks.capacity() * sizeof(int32_t);
+}
+
+uint64_t BrickField::GetHash() const
+{
+	uint64_t hash { 0xCBF29CE484222325ull };
+	auto Mix { [&](uint32_t value) {
+		for (int i { 0 }; i < 4; i++)
+		{
+			hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 0x100000001B3ull;
+		}
+		} };
+
+	Mix(static_cast<uint32_t>(m_Columns));
+	Mix(static_cast<uint32_t>(m_Rows));
+	ForEachLive([&](int column, int row, BrickCell cell) {
+		Mix(static_cast<uint32_t>(column));
+		Mix(static_cast<uint32_t>(row));
+		Mix(static_cast<uint32_t>(cell.type) | static_cast<uint32_t>(cell.hitPoints) << 8);
+		});
+	return hash;
+}
@@ -0,0 +1,136 @@
+#include "brickfieldcache.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+
+void BrickFieldCache::Load(int width, int height)
+{
+	m_Target = LoadRenderTexture(width, height);
+	m_BakedMasks.clear();
+
+	// Anything the field could say differs, so the first Update redraws
+	m_BakedGeneration = UINT32_MAX;
+}
+
+void BrickFieldCache::Unload()
+{
+	if (m_Target.id != 0)
+	{
+		UnloadRenderTexture(m_Target);
+		m_Target = RenderTexture2D { 0 };
+	}
+}
+
+void BrickFieldCache::Update(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites)
+{
+	// Nothing changed, which is almost every frame
+	if (field.GetRevision() == m_BakedRevision && field.GetGeneration() == m_BakedGeneration) return;
+
+	if (field.GetGeneration() != m_BakedGeneration || brickSprites.empty())
+	{
+		Redraw(field, atlas, brickSprites);
+		return;
+	}
+
+	// Same bricks give or take a few, find which appeared or went a chunk at a time
+	m_Changed.clear();
+	for (int chunkRow { 0 }; chunkRow < field.GetChunkRows(); chunkRow++)
+	{
+		for (int chunkColumn { 0 }; chunkColumn < field.GetChunkColumns(); chunkColumn++)
+		{
+			const size_t chunk { static_cast<size_t>(chunkRow) * field.GetChunkColumns() + chunkColumn };
+			uint64_t changed { field.GetChunkMask(chunkColumn, chunkRow) ^ m_BakedMasks[chunk] };
+			while (changed != 0)
+			{
+				const int bit { std::countr_zero(changed) };
+				changed &= changed - 1;
+				m_Changed.push_back({ (chunkColumn << BrickField::m_ChunkShift) | (bit & (BrickField::m_ChunkSize - 1)),
+					(chunkRow << BrickField::m_ChunkShift) | (bit >> BrickField::m_ChunkShift) });
+			}
+
+			if (m_Changed.size() > m_MaxPartialUpdates)
+			{
+				Redraw(field, atlas, brickSprites);
+				return;
+			}
+		}
+	}
+
+	// A brick that took a hit without breaking looks the same, nothing to draw
+	if (m_Changed.empty())
+	{
+		m_BakedRevision = field.GetRevision();
+		return;
+	}
+
+	BeginTextureMode(m_Target);
+	for (const BrickCoord& cell : m_Changed)
+	{
+		if (field.IsLive(cell.column, cell.row))
+		{
+			DrawBrick(field, atlas, brickSprites, cell.column, cell.row);
+		}
+		else
+		{
+			EraseBrick(field, atlas, brickSprites, cell.column, cell.row);
+		}
+
+		const size_t chunk { static_cast<size_t>(cell.row >> BrickField::m_ChunkShift) * field.GetChunkColumns() + (cell.column >> BrickField::m_ChunkShift) };
+		m_BakedMasks[chunk] ^= uint64_t { 1 } << (((cell.row & (BrickField::m_ChunkSize - 1)) << BrickField::m_ChunkShift) | (cell.column & (BrickField::m_ChunkSize - 1)));
+	}
+	EndTextureMode();
+
+	m_BakedRevision = field.GetRevision();
+}
+
+void BrickFieldCache::Redraw(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites)
+{
+	BeginTextureMode(m_Target);
+	ClearBackground(BLANK);
+	if (!brickSprites.empty())
+	{
+		field.ForEachLive([&](int column, int row, BrickCell) {
+			DrawBrick(field, atlas, brickSprites, column, row);
+			});
+	}
+	EndTextureMode();
+
+	m_BakedMasks.resize(static_cast<size_t>(field.GetChunkColumns()) * field.GetChunkRows());
+	for (int chunkRow { 0 }; chunkRow < field.GetChunkRows(); chunkRow++)
+	{
+		for (int chunkColumn { 0 }; chunkColumn < field.GetChunkColumns(); chunkColumn++)
+		{
+			m_BakedMasks[static_cast<size_t>(chunkRow) * field.GetChunkColumns() + chunkColumn] = field.GetChunkMask(chunkColumn, chunkRow);
+		}
+	}
+	m_BakedRevision = field.GetRevision();
+	m_BakedGeneration = field.GetGeneration();
+}
+
+Rectangle BrickFieldCache::PixelBounds(const BrickField& field, int column, int row)
+{
+	// Snapped the same as live sprites, and at least a pixel so tiny bricks in a huge level still show
+	const Rectangle bounds { field.GetCellBounds(column, row) };
+	return Rectangle { std::trunc(bounds.x), std::trunc(bounds.y), std::max(1.0f, std::ceil(bounds.width)), std::max(1.0f, std::ceil(bounds.height)) };
+}
+
+void BrickFieldCache::DrawBrick(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites, int column, int row) const
+{
+	const SpriteID sprite { brickSprites[field.Get(column, row).type % brickSprites.size()] };
+	DrawTexturePro(atlas.GetTexture(), atlas.GetSource(sprite), PixelBounds(field, column, row), { 0.0f, 0.0f }, 0.0f, WHITE);
+}
+
+void BrickFieldCache::EraseBrick(const BrickField& field, const SpriteAtlas& atlas, std::span<const SpriteID> brickSprites, int column, int row) const
+{
+	// Drawing BLANK would just blend over the brick, clearing inside a scissor rect actually removes it
+	const Rectangle bounds { PixelBounds(field, column, row) };
+	BeginScissorMode(static_cast<int>(bounds.x), static_cast<int>(bounds.y), static_cast<int>(bounds.width), static_cast<int>(bounds.height));
+	ClearBackground(BLANK);
+
+	// When bricks are under a pixel apart (a huge level squeezed onto the screen) the clear takes bits of the neighbours with it
+	field.ForEachLiveCell(bounds, [&](int neighbourColumn, int neighbourRow) {
+		DrawBrick(field, atlas, brickSprites, neighbourColumn, neighbourRow);
+		});
+	EndScissorMode();
+}
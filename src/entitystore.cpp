@@ -0,0 +1,113 @@
+#include "entitystore.h"
+
+size_t EntityStore::Add(const Entity& entity)
+{
+	const size_t typeIndex { static_cast<size_t>(entity.type) };
+	const size_t index { m_Ranges[typeIndex].end };
+
+	auto InsertAt { [index](auto& array, const auto& value) {
+		array.insert(array.begin() + index, value);
+		} };
+
+	InsertAt(types, entity.type);
+	InsertAt(flags, entity.flags);
+	InsertAt(spriteIDs, entity.spriteID);
+	InsertAt(sizes, Vector2 { static_cast<float>(entity.width), static_cast<float>(entity.height) });
+	InsertAt(positions, entity.position);
+	InsertAt(previousPositions, entity.position);
+	InsertAt(directions, entity.direction);
+	InsertAt(moveSpeeds, entity.moveSpeed);
+	InsertAt(m_QuerySlots, m_NoQuerySlots);
+
+	// Grow this type's range and shift every range that comes after it
+	m_Ranges[typeIndex].end++;
+	for (size_t i { typeIndex + 1 }; i < m_NumEntityTypes; i++)
+	{
+		m_Ranges[i].begin++;
+		m_Ranges[i].end++;
+	}
+
+	// Same for the queries, only when it didn't go on the end (a ball always does, the paddle comes first)
+	if (index + 1 < Size())
+	{
+		for (std::vector<uint32_t>& indices : m_QueryIndices)
+		{
+			for (uint32_t& queried : indices)
+			{
+				if (queried >= index) queried++;
+			}
+		}
+	}
+
+	// Then add the new entity to the ones it matches
+	for (size_t query { 0 }; query < m_NumQueries; query++)
+	{
+		if (EntityQueries::keys[query].Matches(entity.type, entity.flags))
+		{
+			AddToQuery(query, static_cast<uint32_t>(index));
+		}
+	}
+
+	return index;
+}
+
+void EntityStore::SetFlags(size_t index, uint8_t value)
+{
+	const uint8_t previous { flags[index] };
+	if (previous == value) return;
+
+	flags[index] = value;
+	for (size_t query { 0 }; query < m_NumQueries; query++)
+	{
+		const EntityQueryKey& key { EntityQueries::keys[query] };
+		const bool matched { key.Matches(types[index], previous) };
+		const bool matches { key.Matches(types[index], value) };
+		if (matched == matches) continue;
+
+		if (matches)
+		{
+			AddToQuery(query, static_cast<uint32_t>(index));
+		}
+		else
+		{
+			RemoveFromQuery(query, static_cast<uint32_t>(index));
+		}
+	}
+}
+
+void EntityStore::AddToQuery(size_t query, uint32_t index)
+{
+	std::vector<uint32_t>& indices { m_QueryIndices[query] };
+	m_QuerySlots[index][query] = static_cast<uint32_t>(indices.size());
+	indices.push_back(index);
+}
+
+void EntityStore::RemoveFromQuery(size_t query, uint32_t index)
+{
+	// The last entity in the list takes its slot
+	std::vector<uint32_t>& indices { m_QueryIndices[query] };
+	const uint32_t slot { m_QuerySlots[index][query] };
+	const uint32_t last { indices.back() };
+	indices[slot] = last;
+	m_QuerySlots[last][query] = slot;
+	indices.pop_back();
+	m_QuerySlots[index][query] = m_NotInQuery;
+}
+
+void EntityStore::Clear()
+{
+	types.clear();
+	flags.clear();
+	spriteIDs.clear();
+	sizes.clear();
+	positions.clear();
+	previousPositions.clear();
+	directions.clear();
+	moveSpeeds.clear();
+	m_QuerySlots.clear();
+	m_Ranges = {};
+	for (std::vector<uint32_t>& indices : m_QueryIndices)
+	{
+		indices.clear();
+	}
+}
\ No newline at end of file
@@ -1,264 +1,405 @@
 #include "gamelayer.h"
+#include "application.h"
 #include "globals.h"
+#include "profiler.h"
 #include "raymath.h"
 #include <algorithm>
-#include <string>
+#include <chrono>
 #include <cmath>
+#include <string>
 
 /*
-* All the game entities are initialised in the constructor and when the 
-* textures are loaded the correct texture ID is bound to the type of entity.
-* This allows O(1) lookup of texture when rendering entites in the draw stage.
-
-* Since this style of game has a minimal amount of entities on the screen at anyone time,
-* I chose not to construct or destruct new entities during gameplay or level resets.
-* Instead, entities remain in memory, and code paths are flagged on/off with the 
-* bitmask flags (MOVABLE, VISIBLE, COLLIDABLE, etc.).
+* Nothing is loaded here, the constructor only queues the assets for the worker threads
+* so the window can show the loading layer straight away. See ContinueLoading.
+* Doesn't touch GL either, so it can be constructed off the main thread by a transition.
 */
-GameLayer::GameLayer()
+GameLayer::GameLayer(const GameOptions& options)
 {
-	m_Font = LoadFontEx("../assets/font/NES.ttf", 32, 0, 250);
+	// Baked next to the executable by the breakout_assets target, without it everything is decoded from assets/
+	// (not TextFormat, its buffers aren't safe to use from another thread)
+	const std::string archivePath { std::string { GetApplicationDirectory() } + "assets.pak" };
+	m_Assets.OpenArchive(archivePath.c_str());
 
-	auto AddTexture { [&](const char* path) {
-		Texture2D texture = LoadTexture(path);
-		m_Textures[texture.id] = texture;
-		return texture.id;
-		} };
+	m_AssetIDs.audioDevice =		m_Assets.AddAudioDevice();
+	m_AssetIDs.font =				m_Assets.AddFont("font/NES.ttf", ArchiveFontSize, ArchiveFontGlyphCount);
 
-	Entity paddle;
-	paddle.AddFlag(EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
-	paddle.type =			EntityType::PLAYER;
-	unsigned int paddleID	{ AddTexture("../assets/image/paddle.png") };
-	paddle.textureID =		paddleID;
-	paddle.width =			m_Textures[paddleID].width;
-	paddle.height =			m_Textures[paddleID].height;
-	paddle.position.x =		(GameResolution::f_Width / 2.0f) - (paddle.width / 2);
-	paddle.position.y =		GameResolution::f_Height - paddle.height - 15;
-	paddle.moveSpeed =		400.0f;
-	m_GameState.m_Entities.push_back(paddle);
-
-	Entity ball;
-	ball.AddFlag(EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
-	ball.type =				EntityType::BALL;
-	unsigned int ballID		{ AddTexture("../assets/image/ball_default.png") };
-	ball.textureID =		ballID;
-	ball.width =			m_Textures[ballID].width;
-	ball.height =			m_Textures[ballID].height;
-	ball.position.x =		(GameResolution::f_Width / 2.0f) - (ball.width / 2);
-	ball.position.y =		paddle.position.y - ball.height - 2;
-	ball.moveSpeed =		300.0f;
-	ball.direction =		{ -0.5f, -1.0f };
-	Vector2Normalize(ball.direction);
-	m_GameState.m_Entities.push_back(ball);
-
-	
-	// The order matters 0 = top 3 = bottom
-	unsigned int blockTextureIds[4];
-	blockTextureIds[0] = AddTexture("../assets/image/block_pink.png");
-	blockTextureIds[1] = AddTexture("../assets/image/block_brown.png");
-	blockTextureIds[2] = AddTexture("../assets/image/block_green.png"); 
-	blockTextureIds[3] = AddTexture("../assets/image/block_blue.png"); 
+	m_AssetIDs.paddle =				m_Assets.AddImage("image/paddle.png");
+	m_AssetIDs.ball =				m_Assets.AddImage("image/ball_default.png");
 
-	m_GameState.m_BlockWidth	= m_Textures[blockTextureIds[0]].width;
-	m_GameState.m_BlockHeight	= m_Textures[blockTextureIds[0]].height;
+	// The order matters 0 = top 3 = bottom
+	m_AssetIDs.blocks[0] =			m_Assets.AddImage("image/block_pink.png");
+	m_AssetIDs.blocks[1] =			m_Assets.AddImage("image/block_brown.png");
+	m_AssetIDs.blocks[2] =			m_Assets.AddImage("image/block_green.png");
+	m_AssetIDs.blocks[3] =			m_Assets.AddImage("image/block_blue.png");
+
+	m_AssetIDs.gameOverPanel =		m_Assets.AddImage("image/game_over_panel.png");
+	m_AssetIDs.buttonNormal =		m_Assets.AddImage("image/button_play_again.png");
+	m_AssetIDs.buttonPressed =		m_Assets.AddImage("image/button_pressed_play_again.png");
+
+	m_AssetIDs.soundButton =		m_Assets.AddWave("sound/button_pressed.wav");
+	m_AssetIDs.soundBrick =			m_Assets.AddWave("sound/brick.wav");
+	m_AssetIDs.soundBall =			m_Assets.AddWave("sound/ball.wav");
+	m_AssetIDs.soundLevelComplete =	m_Assets.AddWave("sound/level_complete.wav");
+	m_AssetIDs.soundGameOver =		m_Assets.AddWave("sound/game_over.wav");
+
+	m_Assets.Start();
+
+	if (options.recordPath != nullptr) StartRecording(options.recordPath);
+	if (options.replayPath != nullptr) StartReplay(options.replayPath);
+	if (options.levelPath != nullptr) LoadLevel(options.levelPath);
+	if (options.threadedTickRate > 0.0f) SetThreadedSimulation(options.threadedTickRate);
+	if (options.autoplay) StartAutoplay();
+}
 
-	const int totalBlockWidth	{ (m_GameState.m_MaxBlocksPerRow * m_GameState.m_BlockWidth) + ((m_GameState.m_MaxBlocksPerRow - 1) * m_GameState.m_BlockPadding) };
-	const float startX			{ (GameResolution::f_Width * 0.5f) - (static_cast<float>(totalBlockWidth) * 0.5f) };
+GameLayer::~GameLayer()
+{
+	// Before anything it ticks goes, the recorder included
+	m_SimThread.Stop();
 
+	// The audio device might still be opening on a worker
+	m_Assets.Wait();
 
-	for (int i { 0 }; i < m_GameState.m_NumBlockRows; i++)
+	if (m_Recorder.IsRecording())
 	{
-		for (int j { 0 }; j < m_GameState.m_MaxBlocksPerRow; j++)
+		if (m_Recorder.Save(m_RecordPath))
 		{
-			Entity block;
-			block.type =			EntityType::BLOCK;
-			block.textureID =		blockTextureIds[i];
-			block.width = m_GameState.m_BlockWidth;
-			block.height = m_GameState.m_BlockHeight;
-			block.position.x =		startX + static_cast<float>(j * (m_GameState.m_BlockWidth + m_GameState.m_BlockPadding));
-			block.position.y = m_GameState.m_BlockStartOffset + i * (block.height + m_GameState.m_BlockPadding);
-			block.targetPosition =	block.position;
-			m_GameState.m_Entities.push_back(block);
+			TraceLog(LOG_INFO, "REPLAY: [%s] Saved %llu ticks", m_RecordPath, static_cast<unsigned long long>(m_Recorder.GetTickCount()));
 		}
+		else
+		{
+			TraceLog(LOG_WARNING, "REPLAY: [%s] Failed to save", m_RecordPath);
+		}
+	}
+
+	if (m_LoadStage > LoadStage::SPRITES)
+	{
+		// Back to raylib's default before the atlas goes away
+		SetShapesTexture(Texture2D { 0 }, Rectangle { 0 });
+		m_Atlas.Unload();
+		m_BrickFieldCache.Unload();
+	}
+
+	if (m_LoadStage > LoadStage::FONT)
+	{
+		UnloadFont(m_Font);
+	}
+
+	if (m_LoadStage > LoadStage::SOUNDS)
+	{
+		m_AudioBackend.Unload();
 	}
 
-	const int numBlocksToSkip { (m_GameState.m_MaxBlocksPerRow - m_GameState.m_currentBlocksPerRow) / 2 };
-	int blockCounter { 0 };
-	for (auto& block : m_GameState.m_Entities)
+	if (IsAudioDeviceReady())
+	{
+		CloseAudioDevice();
+	}
+}
+
+/*
+* Called once per frame from Draw (or by the Application during a transition) until
+* everything is loaded. Each stage waits for the workers to finish decoding what it needs,
+* then does its GPU/audio uploads and returns, so the uploads are spread over a few frames
+* instead of one long stall.
+*/
+void GameLayer::ContinueLoading()
+{
+	PROFILE_ZONE("GameLayer::ContinueLoading");
+
+	auto AllReady { [&](std::initializer_list<AssetID> assets) {
+		return std::all_of(assets.begin(), assets.end(), [&](AssetID asset) { return m_Assets.IsReady(asset); });
+		} };
+
+	switch (m_LoadStage)
+	{
+	case LoadStage::LEVEL:
+	{
+		// A big level streams in over a few frames, a broken one falls back to the classic levels
+		if (m_LevelReader.IsOpen() && !m_LevelReader.IsDone())
+		{
+			if (!m_LevelReader.ReadRows(m_Level, m_LevelRowsPerFrame))
+			{
+				TraceLog(LOG_WARNING, "LEVEL: [%s] Corrupt level file, playing the classic levels", m_LevelPath);
+				m_Level = BrickField {};
+			}
+			else if (!m_LevelReader.IsDone())
+			{
+				return;
+			}
+			else
+			{
+				TraceLog(LOG_INFO, "LEVEL: [%s] %dx%d with %zu bricks, %.1f KB", m_LevelPath, m_Level.GetColumns(), m_Level.GetRows(),
+					m_Level.GetLiveCount(), static_cast<double>(m_Level.GetMemoryUsage()) / 1024.0);
+			}
+		}
+
+		m_LoadStage = LoadStage::SPRITES;
+		break;
+	}
+	case LoadStage::SPRITES:
 	{
-		if (block.type != EntityType::BLOCK) continue;
+		if (!AllReady({ m_AssetIDs.paddle, m_AssetIDs.ball, m_AssetIDs.blocks[0], m_AssetIDs.blocks[1], m_AssetIDs.blocks[2],
+			m_AssetIDs.blocks[3], m_AssetIDs.gameOverPanel, m_AssetIDs.buttonNormal, m_AssetIDs.buttonPressed })) return;
 
-		int column { blockCounter % m_GameState.m_MaxBlocksPerRow };
+		LoadSprites();
+		m_LoadStage = LoadStage::FONT;
+		break;
+	}
+	case LoadStage::FONT:
+	{
+		if (!AllReady({ m_AssetIDs.font })) return;
 
-		if (column >= numBlocksToSkip && column < (numBlocksToSkip + m_GameState.m_currentBlocksPerRow))
+		Image fontAtlas { 0 };
+		m_Font = m_Assets.TakeFont(m_AssetIDs.font, fontAtlas);
+		if (m_Font.glyphs != nullptr)
 		{
-			block.AddFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+			m_Font.texture = LoadTextureFromImage(fontAtlas);
+			if (!m_Assets.IsBorrowed(m_AssetIDs.font)) UnloadImage(fontAtlas);
 		}
 		else
 		{
-			block.RemoveFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+			m_Font = GetFontDefault();
 		}
 
-		blockCounter++;
+		InitUIText();
+		m_LoadStage = LoadStage::SOUNDS;
+		break;
+	}
+	case LoadStage::SOUNDS:
+	{
+		if (!AllReady({ m_AssetIDs.audioDevice, m_AssetIDs.soundButton, m_AssetIDs.soundBrick, m_AssetIDs.soundBall,
+			m_AssetIDs.soundLevelComplete, m_AssetIDs.soundGameOver })) return;
+
+		// Same 0.95 - 1.05 spread the old random SetSoundPitch used, in fixed steps
+		constexpr float pitches[] { 0.95f, 0.975f, 1.0f, 1.025f, 1.05f };
+
+		auto LoadSoundAsset { [&](AssetID asset, uint32_t voiceCount) {
+			Wave wave { m_Assets.TakeWave(asset) };
+			const Audio::EffectID effect { m_VoicePool.AddEffect(wave, pitches, voiceCount) };
+			if (!m_Assets.IsBorrowed(asset)) UnloadWave(wave);
+			return effect;
+			} };
+
+		// Bricks and the ball can go off every tick with a few balls in play, the jingles can't overlap
+		m_Sounds.button =			LoadSoundAsset(m_AssetIDs.soundButton, 2);
+		m_Sounds.brick =			LoadSoundAsset(m_AssetIDs.soundBrick, 8);
+		m_Sounds.ball =				LoadSoundAsset(m_AssetIDs.soundBall, 4);
+		m_Sounds.levelComplete =	LoadSoundAsset(m_AssetIDs.soundLevelComplete, 1);
+		m_Sounds.gameOver =			LoadSoundAsset(m_AssetIDs.soundGameOver, 1);
+
+		m_LoadStage = LoadStage::DONE;
+		TraceLog(LOG_INFO, "GAME: Assets ready after %.1f ms", Application::Instance().GetElapsedMilliseconds());
+
+		if (m_ThreadedTickLength > 0.0f)
+		{
+			// The tick owns its input, a replay writes over it
+			m_SimThread.Start(m_GameState, m_ThreadedTickLength, [this](const SimInput& input, float deltaTime) {
+				SimInput tickInput { input };
+				return StepSimulation(tickInput, deltaTime);
+				});
+		}
+		break;
+	}
+	case LoadStage::DONE:
+		break;
 	}
+}
+
+/*
+* All the game entities are initialised by the simulation and when the
+* sprites are added to the atlas the correct sprite ID is bound to the type of entity.
+* This allows O(1) lookup of the source rect when rendering entites in the draw stage.
+*/
+void GameLayer::LoadSprites()
+{
+	// Images from the archive are only borrowed, the atlas must not free them
+	auto AddSprite { [&](AssetID asset) {
+		return m_Atlas.Add(m_Assets.TakeImage(asset), !m_Assets.IsBorrowed(asset));
+		} };
 
+	SimLayout layout;
+	layout.paddleSpriteID =		AddSprite(m_AssetIDs.paddle);
+	layout.ballSpriteID =		AddSprite(m_AssetIDs.ball);
+	for (int i { 0 }; i < GameState::m_NumBlockRows; i++)
+	{
+		m_BrickSpriteIDs[i] = AddSprite(m_AssetIDs.blocks[i]);
+	}
 
 	// UI
-	unsigned int gameOverPanelID	{ AddTexture("../assets/image/game_over_panel.png") };
-	unsigned int buttonNormalID		{ AddTexture("../assets/image/button_play_again.png") };
-	unsigned int buttonPressedID	{ AddTexture("../assets/image/button_pressed_play_again.png") };
+	const SpriteID gameOverPanelID	{ AddSprite(m_AssetIDs.gameOverPanel) };
+	const SpriteID buttonNormalID	{ AddSprite(m_AssetIDs.buttonNormal) };
+	const SpriteID buttonPressedID	{ AddSprite(m_AssetIDs.buttonPressed) };
+
+	// Rectangles are drawn from a white pixel in the atlas so they batch with the sprites
+	const SpriteID whitePixelID		{ m_Atlas.Add(GenImageColor(1, 1, WHITE)) };
+
+	m_Atlas.Build();
+	SetShapesTexture(m_Atlas.GetTexture(), m_Atlas.GetSource(whitePixelID));
+	m_RenderQueue.SetShapesTexture(m_Atlas.GetTexture());
+
+	layout.paddleWidth =		static_cast<int>(m_Atlas.GetSource(layout.paddleSpriteID).width);
+	layout.paddleHeight =		static_cast<int>(m_Atlas.GetSource(layout.paddleSpriteID).height);
+	layout.ballWidth =			static_cast<int>(m_Atlas.GetSource(layout.ballSpriteID).width);
+	layout.ballHeight =			static_cast<int>(m_Atlas.GetSource(layout.ballSpriteID).height);
+	layout.blockWidth =			static_cast<int>(m_Atlas.GetSource(m_BrickSpriteIDs[0]).width);
+	layout.blockHeight =		static_cast<int>(m_Atlas.GetSource(m_BrickSpriteIDs[0]).height);
+
+	// A replay has to start from the same seed, the layout is whatever the sprites say
+	// though so warn if the replay was recorded with different sized sprites or another level
+	uint32_t seed { static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count()) };
+	const uint32_t levelHash { m_Level.IsEmpty() ? 0 : static_cast<uint32_t>(m_Level.GetHash()) };
+	if (m_Replay.IsPlaying())
+	{
+		seed = m_Replay.GetHeader().seed;
+		const SimLayout recorded { m_Replay.GetLayout() };
+		if (recorded.paddleWidth != layout.paddleWidth || recorded.paddleHeight != layout.paddleHeight ||
+			recorded.ballWidth != layout.ballWidth || recorded.ballHeight != layout.ballHeight ||
+			recorded.blockWidth != layout.blockWidth || recorded.blockHeight != layout.blockHeight)
+		{
+			TraceLog(LOG_WARNING, "REPLAY: Recorded with different sprite sizes, it won't play back the same");
+		}
+
+		if (m_Replay.GetHeader().levelHash != levelHash)
+		{
+			TraceLog(LOG_WARNING, "REPLAY: Recorded on %s, it won't play back the same",
+				m_Replay.GetHeader().levelHash == 0 ? "the classic levels" : "a different level");
+		}
+	}
+
+	m_Simulation.SetLevel(std::move(m_Level));
+	m_Simulation.Init(layout, seed);
+	if (m_RecordPath != nullptr) m_Recorder.Begin(seed, layout, levelHash);
+	m_BrickFieldCache.Load(GameResolution::width, GameResolution::height);
+
 
 	// Calculate total height to centre both panel and button
-	const float panelHeight		{ static_cast<float>(m_Textures[gameOverPanelID].height) };
-	const float buttonHeight	{ static_cast<float>(m_Textures[buttonNormalID].height) };
+	const Rectangle& panelSource	{ m_Atlas.GetSource(gameOverPanelID) };
+	const Rectangle& buttonSource	{ m_Atlas.GetSource(buttonNormalID) };
+	const float panelHeight		{ panelSource.height };
+	const float buttonHeight	{ buttonSource.height };
 	const float spacing			{ 6.0f };
 	const float totalHeight		{ panelHeight + spacing + buttonHeight };
 	const float startY			{ (GameResolution::f_Height - totalHeight) * 0.5f };
 
-	m_PanelGameOver.textureID = gameOverPanelID;
+	m_PanelGameOver.spriteID = gameOverPanelID;
 	m_PanelGameOver.bounds = {
-		(GameResolution::f_Width - m_Textures[gameOverPanelID].width) * 0.5f,
+		(GameResolution::f_Width - panelSource.width) * 0.5f,
 		startY,
-		static_cast<float>(m_Textures[gameOverPanelID].width),
+		panelSource.width,
 		panelHeight
 	};
 
-	m_ButtonPlayAgain.textureID = buttonNormalID;
-	m_ButtonPlayAgain.pressedTextureID = buttonPressedID;
+	m_ButtonPlayAgain.spriteID = buttonNormalID;
+	m_ButtonPlayAgain.pressedSpriteID = buttonPressedID;
 	m_ButtonPlayAgain.bounds = {
-		(GameResolution::f_Width - m_Textures[buttonNormalID].width) * 0.5f,
+		(GameResolution::f_Width - buttonSource.width) * 0.5f,
 		startY + panelHeight + spacing,
-		static_cast<float>(m_Textures[buttonNormalID].width),
+		buttonSource.width,
 		buttonHeight
 	};
+}
 
+float GameLayer::GetLoadProgress() const
+{
+	// Decoding jobs plus the upload stages
+	constexpr size_t uploadStages { static_cast<size_t>(LoadStage::DONE) };
+	const size_t done { m_Assets.GetReadyCount() + static_cast<size_t>(m_LoadStage) };
+	return static_cast<float>(done) / static_cast<float>(m_Assets.GetJobCount() + uploadStages);
+}
 
-	// Sound
-	InitAudioDevice();
-	m_SoundButton =			LoadSound("../assets/sound/button_pressed.wav");
-	m_SoundBrick =			LoadSound("../assets/sound/brick.wav");
-	m_SoundBall =			LoadSound("../assets/sound/ball.wav");
-	m_SoundLevelComplete =	LoadSound("../assets/sound/level_complete.wav");
-	m_SoundGameOver =		LoadSound("../assets/sound/game_over.wav");
+void GameLayer::StartRecording(const char* path)
+{
+	m_RecordPath = path;
 }
 
-GameLayer::~GameLayer()
+bool GameLayer::StartReplay(const char* path)
 {
-	for (auto& [id, texture] : m_Textures)
+	if (!m_Replay.Load(path))
 	{
-		UnloadTexture(texture);
+		TraceLog(LOG_WARNING, "REPLAY: [%s] Couldn't load replay", path);
+		return false;
 	}
-	m_Textures.clear();
 
-	UnloadFont(m_Font);
-	UnloadSound(m_SoundButton);
-	UnloadSound(m_SoundBall);
-	UnloadSound(m_SoundBrick);
-	UnloadSound(m_SoundLevelComplete);
-	UnloadSound(m_SoundGameOver);
-
-	CloseAudioDevice();
+	TraceLog(LOG_INFO, "REPLAY: [%s] Playing %llu ticks", path, static_cast<unsigned long long>(m_Replay.GetHeader().tickCount));
+	return true;
 }
 
-// Set up the game for the next game after the player clicks play again
-void GameLayer::ResetGame()
+bool GameLayer::LoadLevel(const char* path)
 {
-	// Reset score
-	m_GameState.m_Score = 0;
-
-	// Reset blocks per row to initial value
-	m_GameState.m_currentBlocksPerRow = 7;
-
-	// Reset paddle positions
-	for (auto& paddle : m_GameState.m_Entities)
-	{
-		if (paddle.type == EntityType::PLAYER)
-		{
-			// Reset paddle to center
-			paddle.position.x = (GameResolution::f_Width / 2.0f) - (paddle.width / 2);
-			paddle.position.y = GameResolution::f_Height - paddle.height - 15;
-			paddle.direction = { 0.0f, 0.0f };
-		}
-	}
-
-	// Reset ball position relative to the paddle
-	for (auto& ball : m_GameState.m_Entities)
+	m_LevelPath = path;
+	if (!m_LevelReader.Open(path))
 	{
-		if (ball.type != EntityType::BALL) continue;
-		
-		// Find paddle to position ball relative to it
-		for (const auto& paddle : m_GameState.m_Entities)
-		{
-			if (paddle.type != EntityType::PLAYER) continue;
-			
-			ball.position.x = (GameResolution::f_Width / 2.0f) - (ball.width / 2);
-			ball.position.y = paddle.position.y - ball.height - 2;
-			break;
-		}
-		ball.direction = { -0.5f, -1.0f };
-		ball.AddFlag(EntityFlags::VISIBLE);
+		TraceLog(LOG_WARNING, "LEVEL: [%s] Couldn't open level", path);
+		return false;
 	}
 
-	// Reset block visibility based on m_currentBlocksPerRow
-	const int numBlocksToSkip { (m_GameState.m_MaxBlocksPerRow - m_GameState.m_currentBlocksPerRow) / 2 };
-	int blockCounter { 0 };
-	for (auto& block : m_GameState.m_Entities)
-	{
-		if (block.type != EntityType::BLOCK) continue;
-
-		int column { blockCounter % m_GameState.m_MaxBlocksPerRow };
+	return true;
+}
 
-		// Reset position to target (in case of animation state)
-		block.position = block.targetPosition;
-		block.RemoveFlag(EntityFlags::ANIMATING);
+void GameLayer::SetThreadedSimulation(float tickRate)
+{
+	m_ThreadedTickLength = 1.0f / tickRate;
+}
 
-		if (column >= numBlocksToSkip && column < (numBlocksToSkip + m_GameState.m_currentBlocksPerRow))
-		{
-			block.AddFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
-		}
-		else
-		{
-			block.RemoveFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
-		}
+void GameLayer::StartAutoplay()
+{
+	m_Autoplayer.emplace(Autoplayer { 1, false, AutoplayAim::PREDICTED_LANDING });
+}
 
-		blockCounter++;
+GameView GameLayer::GetView() const
+{
+	if (m_SimThread.IsRunning())
+	{
+		const SimSnapshot& snapshot { m_SimThread.GetSnapshot() };
+		return GameView { snapshot.entities, snapshot.bricks, snapshot.gameMode, snapshot.score, snapshot.highScore };
 	}
+
+	return GameView { m_GameState.m_Entities, m_GameState.m_Bricks, m_GameState.m_GameMode, m_GameState.m_Score, m_GameState.m_HighScore };
 }
 
 bool GameLayer::ProcessInput()
 {
+	if (m_LoadStage != LoadStage::DONE) return false;
+
+	const GameMode gameMode { GetView().gameMode };
 	bool inputProcessed { false };
 
-	if (m_GameState.m_GameMode == GameMode::PAUSED)
+	if (gameMode == GameMode::PAUSED)
 	{
 		if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER))
 		{
-			m_GameState.m_GameMode = GameMode::PLAYING;
+			m_Input.confirm = true;
+			SubmitInput();
 			return true;
 		}
 	}
 
-	for (auto& entity : m_GameState.m_Entities)
+	m_Input.paddleDirection = 0.0f;
+
+	if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
 	{
-		if (entity.type == EntityType::PLAYER)
-		{
-			entity.direction.x = 0.0f;
+		m_Input.paddleDirection -= 1.0f;
+		inputProcessed = true;
+	}
 
-			if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
-			{
-				entity.direction.x -= 1.0f;
-				inputProcessed = true;
-			}
+	if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
+	{
+		m_Input.paddleDirection += 1.0f;
+		inputProcessed = true;
+	}
 
-			if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
-			{
-				entity.direction.x += 1.0f;
-				inputProcessed = true;
-			}
-		}
+	if (IsKeyPressed(KEY_F3))
+	{
+		m_ShowRenderStats = !m_ShowRenderStats;
+	}
+
+	// Multi-ball
+	if (gameMode == GameMode::PLAYING && IsKeyPressed(KEY_M))
+	{
+		m_Input.spawnBalls += 100;
+		inputProcessed = true;
 	}
 
-	if (m_GameState.m_GameMode == GameMode::GAME_OVER)
+	if (gameMode == GameMode::GAME_OVER)
 	{
 		Vector2 mousePos { GetMousePosition() };
 		Vector2 gameMousePos { GetScreenToWorld2D(mousePos, m_Camera2D) };
@@ -274,483 +415,256 @@ bool GameLayer::ProcessInput()
 
 			if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
 			{
-				Audio::PlaySoundRandomisedPitch(m_SoundButton);
-				ResetGame();
-				m_GameState.m_GameMode = GameMode::PAUSED;
+				m_VoicePool.Play(m_Sounds.button);
+				m_Input.confirm = true;
 			}
 		}
 
 		if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER))
 		{
-			ResetGame();
-			m_GameState.m_GameMode = GameMode::PAUSED;
+			m_Input.confirm = true;
 		}
 	}
 
+	SubmitInput();
 	return inputProcessed;
 }
 
+void GameLayer::SubmitInput()
+{
+	// The sim thread takes the presses whenever its next tick is, serially Update clears them
+	if (!m_SimThread.IsRunning()) return;
+
+	m_SimThread.SubmitInput(m_Input);
+	m_Input.confirm = false;
+	m_Input.spawnBalls = 0;
+}
+
 void GameLayer::Update(float deltaTime)
 {
-	CanvasTransform canvasTransform { CalculateCanvasTransform() };
-	m_Camera2D.zoom = canvasTransform.scale;
-	m_Camera2D.offset = canvasTransform.offset;
+	if (m_LoadStage != LoadStage::DONE) return;
 
-	switch (m_GameState.m_GameMode)
-	{
-	case GameMode::PAUSED:
+	if (m_SimThread.IsRunning())
 	{
-		// Update paddle movement
-		for (auto& entity : m_GameState.m_Entities)
-		{
-			if (entity.type == EntityType::PLAYER)
-			{
-				const float displacement { entity.moveSpeed * deltaTime };
-				entity.position.x += entity.direction.x * displacement;
-				entity.position.y += entity.direction.y * displacement;
-				entity.position.x = std::clamp(entity.position.x, 0.0f, GameResolution::f_Width - static_cast<float>(entity.width));
-				break;
-			}
-		}
-
-		// Make ball stick to paddle
-		for (auto& ball : m_GameState.m_Entities)
-		{
-			if (ball.type != EntityType::BALL) continue;
+		PlayEventSounds(m_SimThread.TakeEvents());
+		return;
+	}
 
-			for (const auto& paddle : m_GameState.m_Entities)
-			{
-				if (paddle.type != EntityType::PLAYER) continue;
+	const uint8_t events { StepSimulation(m_Input, deltaTime) };
+	m_Input.confirm = false;
+	m_Input.spawnBalls = 0;
 
-				// Position ball centered above paddle
-				ball.position.x = paddle.position.x + (paddle.width / 2.0f) - (ball.width / 2.0f);
-				ball.position.y = paddle.position.y - ball.height - 2;
-				break;
-			}
-		}
+	PlayEventSounds(events);
+}
 
-	}
-	break;
-	case GameMode::PLAYING:
+uint8_t GameLayer::StepSimulation(SimInput& input, float deltaTime)
+{
+	// A replay goes through the same Step as the keyboard, at the tick length it was recorded with
+	if (m_Replay.IsPlaying() && !m_Replay.Next(input, deltaTime))
 	{
-		UpdateEntities(deltaTime);
-		HandleCollisions();
-		CheckGameRules();
+		TraceLog(LOG_INFO, "REPLAY: Finished after %llu ticks, back to live input", static_cast<unsigned long long>(m_Replay.GetTicksPlayed()));
+		input = SimInput {};
 	}
-	break;
-	case GameMode::LEVEL_CLEAR:
-	{
-		// Respawn blocks
-		m_GameState.m_currentBlocksPerRow += 2;
-		m_GameState.m_currentBlocksPerRow = std::min(m_GameState.m_currentBlocksPerRow, m_GameState.m_MaxBlocksPerRow);
-
 
-		const float totalBlockHeight { m_GameState.m_BlockStartOffset + 
-			(m_GameState.m_NumBlockRows * m_GameState.m_BlockHeight) + 
-			((m_GameState.m_NumBlockRows - 1) * m_GameState.m_BlockPadding) };
-		const float offscreenOffset { totalBlockHeight + m_GameState.m_BlockHeight };
-
-		// Move all blocks offscreen
-		for (auto& block : m_GameState.m_Entities)
-		{
-			if (block.type != EntityType::BLOCK) continue;
-			block.position.y = block.targetPosition.y - offscreenOffset;
-			block.AddFlag(EntityFlags::ANIMATING);
-		}
+	if (m_Autoplayer && !m_Replay.IsPlaying())
+	{
+		input = m_Autoplayer->NextInput(m_GameState);
+	}
 
-		// Update visibility flags based on level
-		const int numBlocksToSkip { (m_GameState.m_MaxBlocksPerRow - m_GameState.m_currentBlocksPerRow) / 2 };
-		int blockCounter { 0 };
-		for (auto& block : m_GameState.m_Entities)
-		{
-			if (block.type != EntityType::BLOCK) continue;
+	m_Recorder.Record(input, deltaTime);
+	return m_Simulation.Step(input, deltaTime);
+}
 
-			int column { blockCounter % m_GameState.m_MaxBlocksPerRow };
+void GameLayer::PlayEventSounds(uint8_t events)
+{
+	PROFILE_ZONE("GameLayer::PlayEventSounds");
+	if (events & (EVENT_WALL_HIT | EVENT_PADDLE_HIT))
+	{
+		m_VoicePool.Play(m_Sounds.ball);
+	}
 
-			if (column >= numBlocksToSkip && column < (numBlocksToSkip + m_GameState.m_currentBlocksPerRow))
-			{
-				block.AddFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
-			}
-			else
-			{
-				block.RemoveFlag(EntityFlags::VISIBLE | EntityFlags::COLLIDABLE | EntityFlags::ANIMATING);
-			}
+	if (events & EVENT_BLOCK_HIT)
+	{
+		m_VoicePool.Play(m_Sounds.brick);
+	}
 
-			blockCounter++;
-		}
-		m_GameState.m_GameMode = GameMode::PLAYING;
-	} 
-	break;
-	case GameMode::GAME_OVER:
+	if (events & EVENT_GAME_OVER)
 	{
+		m_VoicePool.Play(m_Sounds.gameOver);
+	}
 
+	if (events & EVENT_LEVEL_COMPLETE)
+	{
+		m_VoicePool.Play(m_Sounds.levelComplete);
 	}
-	break;
-	}	
 }
 
-void GameLayer::Draw()
+void GameLayer::Draw(float interpolationAlpha)
 {
-	// Darker gray than the background
-	constexpr Color windowBackgroundColour { 28, 28, 28, 255 };
-	ClearBackground(windowBackgroundColour);
-
-	BeginMode2D(m_Camera2D);
-
-	// Draw a different coloured rectangle for the game area this helps people see the edge walls when not playing on a 4:3 aspect ratio 
-	DrawRectangle(0, 0, GameResolution::width, GameResolution::height, m_BackgroundColour);
-
-	for (const auto& entity : m_GameState.m_Entities)
+	if (m_LoadStage != LoadStage::DONE)
 	{
-		if (entity.HasFlag(EntityFlags::VISIBLE))
-		{
-			const Texture2D& entityTexture { m_Textures.at(entity.textureID) };
-			DrawTexture(entityTexture, entity.position.x, entity.position.y, WHITE);
-		}
+		ContinueLoading();
+		if (m_LoadStage != LoadStage::DONE) return;
 	}
 
-	const float centreX { GameResolution::f_Width * 0.5f };
-	const float centreY { GameResolution::f_Height * 0.5f };
-
-	const std::string scoreText { std::to_string(m_GameState.m_Score) };
-	const Vector2 scoreTextSize { MeasureTextEx(m_Font, scoreText.c_str(), 16, 2) };
-	const float centreTextX { centreX - (scoreTextSize.x * 0.5f) };
-	const float centreTextY { (m_GameState.m_BlockStartOffset - scoreTextSize.y) * 0.5f };
-	DrawTextEx(m_Font, scoreText.c_str(), { centreTextX, centreTextY }, 16, 2, WHITE);
-
+	CanvasTransform canvasTransform { CalculateCanvasTransform() };
+	m_Camera2D.zoom = canvasTransform.scale;
+	m_Camera2D.offset = canvasTransform.offset;
 
-	if (m_GameState.m_GameMode == GameMode::PAUSED)
+	// The sim thread's ticks don't line up with Application's, so it's the time since the snapshot's tick that says how far to interpolate
+	if (m_SimThread.IsRunning())
 	{
-		// Dim the background
-		DrawRectangle(0, 0, GameResolution::width, GameResolution::height, Fade(BLACK, 0.25f));
-
-
-		const std::string readyText { "ready?" };
-		const Vector2 readyTextSize { MeasureTextEx(m_Font, readyText.c_str(), 22, 2) };
-		const std::string startPromptText { "press space or enter to start" };
-		const Vector2 startPromptTextSize { MeasureTextEx(m_Font, startPromptText.c_str(), 12, 2) };
-
-		const float readyTextX { (GameResolution::f_Width - readyTextSize.x) * 0.5f };
-		const float readyTextY { (GameResolution::f_Height - readyTextSize.y) * 0.5f };
-		const float startPromptTextX { (GameResolution::f_Width - startPromptTextSize.x) * 0.5f };
-		const float startPromptTextY { (GameResolution::f_Height - startPromptTextSize.y) * 0.5f };
-
-
-		DrawTextEx(m_Font, readyText.c_str(), { readyTextX, readyTextY - startPromptTextSize.y }, 22, 2, WHITE);
-		DrawTextEx(m_Font, startPromptText.c_str(), { startPromptTextX, startPromptTextY + readyTextSize.y }, 12, 2, WHITE);
+		m_SimThread.AcquireSnapshot();
+		interpolationAlpha = m_SimThread.GetInterpolationAlpha(std::chrono::steady_clock::now());
 	}
 
-	if (m_GameState.m_GameMode == GameMode::GAME_OVER)
+	const GameView view { GetView() };
 	{
-		// Dim the background
-		DrawRectangle(0, 0, GameResolution::width, GameResolution::height, Fade(BLACK, 0.25f));
-
-		const Texture2D& panelTexture { m_Textures.at(m_PanelGameOver.textureID) };
-		DrawTexture(panelTexture, m_PanelGameOver.bounds.x, m_PanelGameOver.bounds.y, WHITE);
-
-
-		// Draw score and high score on panel
-		constexpr float fontSize { 16 };
-		constexpr float fontSpacing { 2 };
-		constexpr float labelValueSpacing { 4.0f };  // vertical gap between label and value
-		constexpr float columnSpacing { 40.0f };      // horizontal gap between score and high columns
-
-		// Score column
-		const std::string scoreLabelText { "score" };
-		const std::string scoreValueText { std::to_string(m_GameState.m_Score) };
-		const Vector2 scoreLabelSize { MeasureTextEx(m_Font, scoreLabelText.c_str(), fontSize, fontSpacing) };
-		const Vector2 scoreValueSize { MeasureTextEx(m_Font, scoreValueText.c_str(), fontSize, fontSpacing) };
-		const float scoreColumnWidth { std::max(scoreLabelSize.x, scoreValueSize.x) };
-
-		// High score column
-		const std::string highLabelText { "high" };
-		const std::string highValueText { std::to_string(m_GameState.m_HighScore) };
-		const Vector2 highLabelSize { MeasureTextEx(m_Font, highLabelText.c_str(), fontSize, fontSpacing) };
-		const Vector2 highValueSize { MeasureTextEx(m_Font, highValueText.c_str(), fontSize, fontSpacing) };
-		const float highColumnWidth { std::max(highLabelSize.x, highValueSize.x) };
-
-		// Calculate total dimensions for centering
-		const float totalWidth { scoreColumnWidth + columnSpacing + highColumnWidth };
-		const float rowHeight { fontSize + labelValueSpacing + fontSize };
-
-		// Center the entire block in the panel
-		const float startX { m_PanelGameOver.bounds.x + (m_PanelGameOver.bounds.width - totalWidth) * 0.5f };
-		const float startY { m_PanelGameOver.bounds.y + (m_PanelGameOver.bounds.height - rowHeight) * 0.5f };
-
-		// Draw score column (centred within its column)
-		const float scoreLabelX { startX + (scoreColumnWidth - scoreLabelSize.x) * 0.5f };
-		const float scoreValueX { startX + (scoreColumnWidth - scoreValueSize.x) * 0.5f };
-		DrawTextEx(m_Font, scoreLabelText.c_str(), { scoreLabelX, startY }, fontSize, fontSpacing, WHITE);
-		DrawTextEx(m_Font, scoreValueText.c_str(), { scoreValueX, startY + fontSize + labelValueSpacing }, fontSize, fontSpacing, WHITE);
-
-		// Draw high score column (centred within its column)
-		const float highColumnStartX { startX + scoreColumnWidth + columnSpacing };
-		const float highLabelX { highColumnStartX + (highColumnWidth - highLabelSize.x) * 0.5f };
-		const float highValueX { highColumnStartX + (highColumnWidth - highValueSize.x) * 0.5f };
-		DrawTextEx(m_Font, highLabelText.c_str(), { highLabelX, startY }, fontSize, fontSpacing, WHITE);
-		DrawTextEx(m_Font, highValueText.c_str(), { highValueX, startY + fontSize + labelValueSpacing }, fontSize, fontSpacing, WHITE);
+		PROFILE_ZONE("BrickFieldCache::Update");
+		m_BrickFieldCache.Update(view.bricks, m_Atlas, m_BrickSpriteIDs);
+	}
 
-		// Draw Game Over text
-		const std::string gameOverText { "game over" };
-		const Vector2 gameOverTextSize { MeasureTextEx(m_Font, gameOverText.c_str(), 22, 2) };
-		const float gameOverTextX { m_PanelGameOver.bounds.x + (m_PanelGameOver.bounds.width - gameOverTextSize.x) * 0.5f };
-		const float gameOverTextY { m_PanelGameOver.bounds.y + 15 };
-		DrawTextEx(m_Font, gameOverText.c_str(), { gameOverTextX, gameOverTextY }, 22, 2, WHITE);
+	// Darker gray than the background
+	constexpr Color windowBackgroundColour { 28, 28, 28, 255 };
+	ClearBackground(windowBackgroundColour);
 
-		// Button texture
-		unsigned int buttonTextureID { m_ButtonPlayAgain.isPressed ?
-				m_ButtonPlayAgain.pressedTextureID : m_ButtonPlayAgain.textureID };
-		const Texture2D& buttonTexture { m_Textures.at(buttonTextureID) };
-		DrawTexture(buttonTexture, m_ButtonPlayAgain.bounds.x, m_ButtonPlayAgain.bounds.y, WHITE);
-	}
+	m_RenderQueue.Begin();
 
-	EndMode2D();
-}
+	GameViewSprites sprites;
+	sprites.atlas = m_Atlas.GetTexture();
+	sprites.sources = m_Atlas.GetSources();
+	sprites.brickField = m_BrickFieldCache.GetTexture();
+	sprites.brickSprites = m_BrickSpriteIDs;
+	sprites.background = m_BackgroundColour;
+	RecordGameView(m_RenderQueue, view, sprites, interpolationAlpha);
 
-void GameLayer::UpdateEntities(float deltaTime)
-{
-	// Handle animating blocks
-	for (auto& entity : m_GameState.m_Entities)
 	{
-		if (entity.HasFlag(EntityFlags::ANIMATING))
-		{
-			constexpr float lerpSpeed { 1.5f };
-			entity.position.y = Lerp(entity.position.y, entity.targetPosition.y, lerpSpeed * deltaTime);
+		PROFILE_ZONE("GameLayer::PushUI");
+		UpdateUILayout(view);
+		m_ScoreText.Push(m_RenderQueue, RENDER_LAYER_HUD);
 
-			if (fabs(entity.position.y - entity.targetPosition.y) <= 0.0f)
-			{
-				entity.position.y = entity.targetPosition.y;
-				entity.RemoveFlag(EntityFlags::ANIMATING);
-			}
+		// RecordGameView has dimmed the background for both of these
+		if (view.gameMode == GameMode::PAUSED)
+		{
+			m_ReadyText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+			m_StartPromptText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
 		}
-	}
 
-	// Update movement
-	for (auto& entity : m_GameState.m_Entities)
-	{
-		if (entity.HasFlag(EntityFlags::MOVABLE))
+		if (view.gameMode == GameMode::GAME_OVER)
 		{
-			const float displacement { entity.moveSpeed * deltaTime };
-			entity.position.x += entity.direction.x * displacement;
-			entity.position.y += entity.direction.y * displacement;
+			PushSprite(RENDER_LAYER_UI, m_PanelGameOver.spriteID, { m_PanelGameOver.bounds.x, m_PanelGameOver.bounds.y });
+
+			m_GameOverText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+			m_ScoreLabelText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+			m_ScoreValueText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+			m_HighLabelText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+			m_HighValueText.Push(m_RenderQueue, RENDER_LAYER_UI_TEXT);
+
+			// Button texture
+			const SpriteID buttonSpriteID { m_ButtonPlayAgain.isPressed ?
+					m_ButtonPlayAgain.pressedSpriteID : m_ButtonPlayAgain.spriteID };
+			PushSprite(RENDER_LAYER_UI, buttonSpriteID, { m_ButtonPlayAgain.bounds.x, m_ButtonPlayAgain.bounds.y });
 		}
 
-		if (entity.type == EntityType::PLAYER)
+		// Last frame's counters, drawn in screen space in the corner of the window
+		if (m_ShowRenderStats)
 		{
-			entity.position.x = std::clamp(entity.position.x, 0.0f, GameResolution::f_Width - static_cast<float>(entity.width));
+			const RenderStats& stats { m_RenderQueue.GetStats() };
+			const std::string statsText { TextFormat("commands %d  draws %d  flushes %d", stats.commands, stats.drawCalls, stats.batchFlushes) };
+			const Vector2 position { GetScreenToWorld2D({ 4.0f, 4.0f }, m_Camera2D) };
+			m_RenderQueue.PushText(RENDER_LAYER_UI_TEXT, m_Font, statsText.c_str(), position, 8, 1, GREEN);
 		}
 	}
+
+	PROFILE_ZONE("RenderQueue::Submit");
+	BeginMode2D(m_Camera2D);
+	m_RenderQueue.Submit(m_RenderBackend);
+	EndMode2D();
 }
 
-void GameLayer::HandleCollisions()
+/*
+* The static text is laid out once here, anything showing a score is laid out by
+* UpdateUILayout when the value changes. Everything is in game resolution coordinates
+* so a window resize (which only changes the camera) never needs a re-layout.
+*/
+void GameLayer::InitUIText()
 {
-	HandleWallCollisions();
-	HandleBlockCollisions();
-	HandlePaddleCollisions();
+	m_ScoreText.Init(m_Font, 16, 2);
+	m_ReadyText.Init(m_Font, 22, 2);
+	m_StartPromptText.Init(m_Font, 12, 2);
+	m_GameOverText.Init(m_Font, 22, 2);
+	m_ScoreLabelText.Init(m_Font, 16, 2);
+	m_ScoreValueText.Init(m_Font, 16, 2);
+	m_HighLabelText.Init(m_Font, 16, 2);
+	m_HighValueText.Init(m_Font, 16, 2);
+
+	m_ReadyText.SetText("ready?");
+	m_StartPromptText.SetText("press space or enter to start");
+	m_GameOverText.SetText("game over");
+	m_ScoreLabelText.SetText("score");
+	m_HighLabelText.SetText("high");
+
+	const Vector2 readyTextSize { m_ReadyText.GetSize() };
+	const Vector2 startPromptTextSize { m_StartPromptText.GetSize() };
+	m_ReadyText.SetPosition({ (GameResolution::f_Width - readyTextSize.x) * 0.5f,
+		(GameResolution::f_Height - readyTextSize.y) * 0.5f - startPromptTextSize.y });
+	m_StartPromptText.SetPosition({ (GameResolution::f_Width - startPromptTextSize.x) * 0.5f,
+		(GameResolution::f_Height - startPromptTextSize.y) * 0.5f + readyTextSize.y });
+
+	const Vector2 gameOverTextSize { m_GameOverText.GetSize() };
+	m_GameOverText.SetPosition({ m_PanelGameOver.bounds.x + (m_PanelGameOver.bounds.width - gameOverTextSize.x) * 0.5f,
+		m_PanelGameOver.bounds.y + 15 });
 }
-void GameLayer::HandleWallCollisions()
-{
-	// Check Collisions with wall
-	bool wallSoundTrigger { false };
-	for (auto& ball : m_GameState.m_Entities)
-	{
-		if (ball.type != EntityType::BALL) continue;
-
-		// Screen Bouncing
-		if (ball.position.x <= 0 || ball.position.x + ball.width >= GameResolution::width)
-		{
-			ball.direction.x *= -1.0f;
-			ball.position.x = std::clamp(ball.position.x, 0.0f, GameResolution::f_Width - ball.width);
-			wallSoundTrigger = true;
-		}
 
-		if (ball.position.y <= 0)
-		{
-			ball.direction.y *= -1.0f;
-			ball.position.y = std::max(0.0f, ball.position.y);
-			wallSoundTrigger = true;
-		}
-	}
-	if (wallSoundTrigger)
-	{
-		if (!IsSoundPlaying(m_SoundBall))
-		{
-			Audio::PlaySoundRandomisedPitch(m_SoundBall);
-		}
-	}
-}
-void GameLayer::HandleBlockCollisions()
+void GameLayer::UpdateUILayout(const GameView& view)
 {
-	// Check ball collision vs blocks
-	bool brickSoundTrigger { false };
-	for (auto& ball : m_GameState.m_Entities)
+	if (m_ScoreText.SetValue(view.score))
 	{
-		if (ball.type != EntityType::BALL) continue;
-
-		Rectangle ballBounds { ball.GetCollider() };
-		bool hasCollided { false };
-
-		for (auto& block : m_GameState.m_Entities)
-		{
-			if (block.type != EntityType::BLOCK) continue;
-			if (!block.HasFlag(EntityFlags::COLLIDABLE)) continue;
-
-			Rectangle blockBounds { block.GetCollider() };
-
-			if (CheckCollisionRecs(ballBounds, blockBounds))
-			{
-				brickSoundTrigger = true;
-				m_GameState.m_Score += 50;
-				block.RemoveFlag(COLLIDABLE);
-				block.RemoveFlag(VISIBLE);
-
-				// Ensure the ball flips direction only once in the case of the ball hitting inbetween two blocks
-				if (!hasCollided)
-				{
-					// Calculate ball and block centers
-					float ballCenterX { ball.position.x + ball.width * 0.5f };
-					float ballCenterY { ball.position.y + ball.height * 0.5f };
-					float blockCenterX { block.position.x + block.width * 0.5f };
-					float blockCenterY { block.position.y + block.height * 0.5f };
-
-					// Get direciton from block centre to the ball centre
-					float deltaX { ballCenterX - blockCenterX };
-					float deltaY { ballCenterY - blockCenterY };
-
-					// Normalise by block dimensions to get aspect-ratio-independent comparison
-					float normalisedX { deltaX / (block.width * 0.5f) };
-					float normalisedY { deltaY / (block.height * 0.5f) };
-
-					// The component with the larger absolute normalised value indicates which side was hit
-					if (std::abs(normalisedX) > std::abs(normalisedY))
-					{
-						// Hit left or right side
-						ball.direction.x *= -1.0f;
-					}
-					else
-					{
-						// Hit top or bottom
-						ball.direction.y *= -1.0f;
-					}
-
-					hasCollided = true;
-				}
-			}
-		}
+		const Vector2 scoreTextSize { m_ScoreText.GetSize() };
+		m_ScoreText.SetPosition({ (GameResolution::f_Width - scoreTextSize.x) * 0.5f,
+			(GameState::m_BlockStartOffset - scoreTextSize.y) * 0.5f });
 	}
 
-	if (brickSoundTrigger)
-	{
-		if (!IsSoundPlaying(m_SoundBrick))
-		{
-			Audio::PlaySoundRandomisedPitch(m_SoundBrick);
-		}
-	}
-}
+	const bool scoreChanged { m_ScoreValueText.SetValue(view.score) };
+	const bool highScoreChanged { m_HighValueText.SetValue(view.highScore) };
+	if (!scoreChanged && !highScoreChanged) return;
 
-void GameLayer::HandlePaddleCollisions()
-{
-	bool paddleSoundTrigger { false };
-	for (auto& ball : m_GameState.m_Entities)
-	{
-		if (ball.type != EntityType::BALL) continue;
+	// Score and high score columns on the game over panel
+	constexpr float fontSize { 16 };
+	constexpr float labelValueSpacing { 4.0f };  // vertical gap between label and value
+	constexpr float columnSpacing { 40.0f };      // horizontal gap between score and high columns
 
-		Rectangle ballBounds { ball.GetCollider() };
+	const Vector2 scoreLabelSize { m_ScoreLabelText.GetSize() };
+	const Vector2 scoreValueSize { m_ScoreValueText.GetSize() };
+	const float scoreColumnWidth { std::max(scoreLabelSize.x, scoreValueSize.x) };
 
-		for (auto& paddle : m_GameState.m_Entities)
-		{
-			if (paddle.type != EntityType::PLAYER) continue;
+	const Vector2 highLabelSize { m_HighLabelText.GetSize() };
+	const Vector2 highValueSize { m_HighValueText.GetSize() };
+	const float highColumnWidth { std::max(highLabelSize.x, highValueSize.x) };
 
-			Rectangle paddleBounds { paddle.GetCollider() };
+	// Calculate total dimensions for centering
+	const float totalWidth { scoreColumnWidth + columnSpacing + highColumnWidth };
+	const float rowHeight { fontSize + labelValueSpacing + fontSize };
 
-			if (CheckCollisionRecs(ballBounds, paddleBounds))
-			{
-				paddleSoundTrigger = true;
-				float paddleCenterX { paddle.position.x + paddle.width * 0.5f };
-				float ballCenterX { ball.position.x + ball.width * 0.5f };
-
-				// Calculate collision centers
-				float paddleCenterY { paddle.position.y + paddle.height * 0.5f };
-				float ballCenterY { ball.position.y + ball.height * 0.5f };
-
-				// Get direction from paddle centre to the ball centre
-				float deltaX { ballCenterX - paddleCenterX };
-				float deltaY { ballCenterY - paddleCenterY };
-
-				// Normalise by paddle dimensions to get aspect-ratio-independent comparison
-				float normalisedX { deltaX / (paddle.width * 0.5f) };
-				float normalisedY { deltaY / (paddle.height * 0.5f) };
-
-				// Scale to make the bounce flatter 
-				float deflection { normalisedX * 1.5f };
-
-				// The y component always shoot us in the opposite y direction
-				Vector2 newDirection { Vector2Normalize({ deflection, -1.0f }) };
-				ball.direction = newDirection;
-
-				// If its a side hit snap x position to side to prevent overlap
-				if (std::abs(normalisedX) >= std::abs(normalisedY))
-				{
-					if (deltaX < 0)
-					{
-						// Left side
-						ball.position.x = paddle.position.x - ball.width;
-					}
-					else
-					{
-						// Right side
-						ball.position.x = paddle.position.x + paddle.width;
-					}
-
-				}
-			}
-		}
-	}
+	// Center the entire block in the panel
+	const float startX { m_PanelGameOver.bounds.x + (m_PanelGameOver.bounds.width - totalWidth) * 0.5f };
+	const float startY { m_PanelGameOver.bounds.y + (m_PanelGameOver.bounds.height - rowHeight) * 0.5f };
 
-	if (paddleSoundTrigger)
-	{
-		if (!IsSoundPlaying(m_SoundBall))
-		{
-			Audio::PlaySoundRandomisedPitch(m_SoundBall);
-		}
-	}
+	// Score column (centred within its column)
+	m_ScoreLabelText.SetPosition({ startX + (scoreColumnWidth - scoreLabelSize.x) * 0.5f, startY });
+	m_ScoreValueText.SetPosition({ startX + (scoreColumnWidth - scoreValueSize.x) * 0.5f, startY + fontSize + labelValueSpacing });
+
+	// High score column (centred within its column)
+	const float highColumnStartX { startX + scoreColumnWidth + columnSpacing };
+	m_HighLabelText.SetPosition({ highColumnStartX + (highColumnWidth - highLabelSize.x) * 0.5f, startY });
+	m_HighValueText.SetPosition({ highColumnStartX + (highColumnWidth - highValueSize.x) * 0.5f, startY + fontSize + labelValueSpacing });
 }
 
-void GameLayer::CheckGameRules()
+void GameLayer::PushSprite(RenderLayer layer, SpriteID sprite, Vector2 position)
 {
-	// Check for game over
-	for (auto& ball : m_GameState.m_Entities)
-	{
-		if (ball.type != EntityType::BALL) continue;
-
-		if (ball.position.y >= GameResolution::f_Height)
-		{
-			ball.RemoveFlag(EntityFlags::VISIBLE);
-			Audio::PlaySoundRandomisedPitch(m_SoundGameOver);
-			m_GameState.m_HighScore = std::max(m_GameState.m_Score, m_GameState.m_HighScore);
-			m_GameState.m_GameMode = GameMode::GAME_OVER;
-			break;
-		}
-	}
-
-	// Check for level completion
-	bool levelComplete { true };
-	for (const auto& block : m_GameState.m_Entities)
-	{
-		if (block.type != EntityType::BLOCK) continue;
-
-		if (block.HasFlag(EntityFlags::VISIBLE))
-		{
-			levelComplete = false;
-		}
-	}
-
-	if (levelComplete)
-	{
-		m_GameState.m_Score += 250;
-		Audio::PlaySoundRandomisedPitch(m_SoundLevelComplete);
-		m_GameState.m_GameMode = GameMode::LEVEL_CLEAR;
-	}
+	// Snap to whole pixels the same as DrawTexture does so the pixel art stays crisp
+	const Vector2 pixelPosition { std::trunc(position.x), std::trunc(position.y) };
+	m_RenderQueue.PushSprite(layer, m_Atlas.GetTexture(), m_Atlas.GetSource(sprite), pixelPosition);
 }
 
 CanvasTransform GameLayer::CalculateCanvasTransform() const
@@ -0,0 +1,56 @@
+#include "gameview.h"
+#include "globals.h"
+#include "profiler.h"
+#include "raymath.h"
+#include <cmath>
+
+void RecordGameView(RenderQueue& queue, const GameView& view, const GameViewSprites& sprites, float interpolationAlpha)
+{
+	const EntityStore& entities { view.entities };
+	const BrickField& bricks { view.bricks };
+	const Rectangle gameArea { 0.0f, 0.0f, GameResolution::f_Width, GameResolution::f_Height };
+
+	// A different coloured rectangle for the game area helps people see the edge walls when not playing on a 4:3 aspect ratio
+	queue.PushRectangle(RENDER_LAYER_BACKGROUND, gameArea, sprites.background);
+
+	// Moved up while the field drops in
+	const float brickFieldOffset { std::trunc(Lerp(bricks.GetPreviousOffsetY(), bricks.GetOffsetY(), interpolationAlpha)) };
+
+	auto PushSprite { [&](SpriteID sprite, Vector2 position) {
+		queue.PushSprite(RENDER_LAYER_WORLD, sprites.atlas, sprites.sources[sprite], Vector2 { std::trunc(position.x), std::trunc(position.y) });
+		} };
+
+	if (sprites.brickField.id != 0)
+	{
+		// The bricks all come from the cache in one quad, flipped back the right way up
+		const float width { static_cast<float>(sprites.brickField.width) };
+		const float height { static_cast<float>(sprites.brickField.height) };
+		queue.PushSprite(RENDER_LAYER_WORLD, sprites.brickField, { 0.0f, 0.0f, width, -height }, Rectangle { 0.0f, brickFieldOffset, width, height });
+	}
+	else if (!sprites.brickSprites.empty())
+	{
+		bricks.ForEachLive([&](int column, int row, BrickCell cell) {
+			const Rectangle bounds { bricks.GetCellBounds(column, row) };
+			PushSprite(sprites.brickSprites[cell.type % sprites.brickSprites.size()], { bounds.x, std::trunc(bounds.y) + brickFieldOffset });
+			});
+	}
+
+	{
+		PROFILE_ZONE("RecordGameView::Entities");
+
+		// Just the paddle and balls, the bricks aren't entities
+		for (size_t entity { 0 }; entity < entities.Size(); entity++)
+		{
+			if (entities.HasFlag(entity, EntityFlags::VISIBLE))
+			{
+				PushSprite(entities.spriteIDs[entity], Vector2Lerp(entities.previousPositions[entity], entities.positions[entity], interpolationAlpha));
+			}
+		}
+	}
+
+	if (view.gameMode == GameMode::PAUSED || view.gameMode == GameMode::GAME_OVER)
+	{
+		// Fade(BLACK, 0.25f), the render library doesn't link raylib
+		queue.PushRectangle(RENDER_LAYER_OVERLAY, gameArea, Color { 0, 0, 0, 63 });
+	}
+}
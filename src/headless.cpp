@@ -0,0 +1,213 @@
+#include "simulation.h"
+#include "gamestate.h"
+#include "replay.h"
+#include "autoplayer.h"
+#include "level.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+// FNV-1a over everything a replay should reproduce, to compare two runs of the same replay
+static uint64_t HashState(const GameState& gameState)
+{
+	uint64_t hash { 0xCBF29CE484222325ull };
+	auto Mix { [&](const void* data, size_t size) {
+		const uint8_t* bytes { static_cast<const uint8_t*>(data) };
+		for (size_t i { 0 }; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+		} };
+
+	const EntityStore& entities { gameState.m_Entities };
+	Mix(entities.positions.data(), entities.positions.size() * sizeof(Vector2));
+	Mix(entities.directions.data(), entities.directions.size() * sizeof(Vector2));
+	Mix(entities.flags.data(), entities.flags.size() * sizeof(entities.flags[0]));
+
+	const uint64_t bricksHash { gameState.m_Bricks.GetHash() };
+	const float bricksOffsetY { gameState.m_Bricks.GetOffsetY() };
+	Mix(&bricksHash, sizeof(bricksHash));
+	Mix(&bricksOffsetY, sizeof(bricksOffsetY));
+	Mix(&gameState.m_Score, sizeof(gameState.m_Score));
+	Mix(&gameState.m_HighScore, sizeof(gameState.m_HighScore));
+	Mix(&gameState.m_GameMode, sizeof(gameState.m_GameMode));
+	Mix(&gameState.m_Random.state, sizeof(gameState.m_Random.state));
+	return hash;
+}
+
+/*
+* Steps the simulation as fast as possible without a window, GL context or
+* audio device and reports the throughput. Intended for CI machines with no GPU.
+*
+* With --replay the inputs come from a replay file instead of the built in autoplayer,
+* so a recorded session runs as fast as the simulation allows. The state hash at the end
+* should match between runs of the same replay on the same build.
+* --record saves the autoplayer's session as a replay.
+* --level plays a level file (see level.h) instead of the classic levels.
+* --predict has the autoplayer aim for where the balls will land instead of chasing the
+* lowest one, it loses far fewer of them so a long soak spends its time playing.
+*
+* Usage: breakout_headless [--ticks N] [--hz H] [--balls B] [--seed S] [--level file] [--record file] [--replay file] [--predict]
+*/
+int main(int argc, char** argv)
+{
+	long long numTicks { 1'000'000 };
+	float tickRate { 120.0f };
+	int numBalls { 1 };
+	uint32_t seed { 0 };
+	const char* recordPath { nullptr };
+	const char* replayPath { nullptr };
+	const char* levelPath { nullptr };
+	AutoplayAim aim { AutoplayAim::LOWEST_BALL };
+
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+		{
+			numTicks = std::atoll(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+		{
+			tickRate = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+		{
+			numBalls = std::atoi(argv[++i]);
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+		{
+			seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			levelPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--predict") == 0)
+		{
+			aim = AutoplayAim::PREDICTED_LANDING;
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--ticks N] [--hz H] [--balls B] [--seed S] [--level file] [--record file] [--replay file] [--predict]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	BrickField level;
+	uint32_t levelHash { 0 };
+	if (levelPath != nullptr)
+	{
+		const auto loadStart { std::chrono::steady_clock::now() };
+		if (!LoadLevel(levelPath, level))
+		{
+			std::fprintf(stderr, "Couldn't load level %s\n", levelPath);
+			return 1;
+		}
+		const double loadMilliseconds { std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count() };
+
+		levelHash = static_cast<uint32_t>(level.GetHash());
+		std::printf("level:          %dx%d, %zu bricks in %zu chunks, %.1f KB, loaded in %.1f ms\n", level.GetColumns(), level.GetRows(),
+			level.GetLiveCount(), level.GetChunkCount(), static_cast<double>(level.GetMemoryUsage()) / 1024.0, loadMilliseconds);
+	}
+
+	ReplayPlayer replay;
+	SimLayout layout;
+	if (replayPath != nullptr)
+	{
+		if (!replay.Load(replayPath))
+		{
+			std::fprintf(stderr, "Couldn't load replay %s\n", replayPath);
+			return 1;
+		}
+
+		if (replay.GetHeader().levelHash != levelHash)
+		{
+			std::fprintf(stderr, "Replay %s was recorded on %s\n", replayPath,
+				replay.GetHeader().levelHash == 0 ? "the classic levels" : "a different level, pass it with --level");
+			return 1;
+		}
+
+		layout = replay.GetLayout();
+		seed = replay.GetHeader().seed;
+		numTicks = static_cast<long long>(replay.GetHeader().tickCount);
+	}
+
+	GameState gameState;
+	Simulation simulation { gameState };
+	simulation.SetLevel(std::move(level));
+	simulation.Init(layout, seed);
+
+	ReplayRecorder recorder;
+	if (recordPath != nullptr)
+	{
+		recorder.Begin(seed, layout, levelHash);
+	}
+
+	float deltaTime { 1.0f / tickRate };
+	SimInput input;
+	long long gamesPlayed { 0 };
+	long long blocksHit { 0 };
+	long long levelsCleared { 0 };
+
+	const auto startTime { std::chrono::steady_clock::now() };
+
+	Autoplayer autoplayer { numBalls, false, aim };
+
+	for (long long tick { 0 }; tick < numTicks; tick++)
+	{
+		if (replay.IsPlaying())
+		{
+			if (!replay.Next(input, deltaTime))
+			{
+				std::fprintf(stderr, "Replay ended early after %lld ticks\n", tick);
+				numTicks = tick;
+				break;
+			}
+		}
+		else
+		{
+			input = autoplayer.NextInput(gameState);
+		}
+
+		recorder.Record(input, deltaTime);
+		const uint8_t events { simulation.Step(input, deltaTime) };
+
+		if (events & EVENT_GAME_OVER) gamesPlayed++;
+		if (events & EVENT_BLOCK_HIT) blocksHit++;
+		if (events & EVENT_LEVEL_COMPLETE) levelsCleared++;
+	}
+
+	const auto endTime { std::chrono::steady_clock::now() };
+	const double seconds { std::chrono::duration<double>(endTime - startTime).count() };
+
+	std::printf("ticks:          %lld\n", numTicks);
+	std::printf("seconds:        %.3f\n", seconds);
+	std::printf("ticks/sec:      %.0f\n", seconds > 0.0 ? numTicks / seconds : 0.0);
+	std::printf("games over:     %lld\n", gamesPlayed);
+	std::printf("levels cleared: %lld\n", levelsCleared);
+	std::printf("block hits:     %lld\n", blocksHit);
+	std::printf("high score:     %d\n", gameState.m_HighScore);
+	std::printf("state hash:     %016llx\n", static_cast<unsigned long long>(HashState(gameState)));
+
+	if (recordPath != nullptr)
+	{
+		if (!recorder.Save(recordPath))
+		{
+			std::fprintf(stderr, "Couldn't write replay %s\n", recordPath);
+			return 1;
+		}
+		std::printf("recorded:       %s\n", recordPath);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "level.h"
+
+static void WriteVarint(std::vector<uint8_t>& data, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<uint8_t>(value));
+}
+
+bool LevelReader::Open(const char* path)
+{
+	m_Open = false;
+	m_File = std::ifstream { path, std::ios::binary };
+	if (!m_File) return false;
+
+	m_File.read(reinterpret_cast<char*>(&m_Header), sizeof(m_Header));
+	if (!m_File || m_Header.magic != LevelMagic || m_Header.version != LevelVersion) return false;
+	if (m_Header.columns > MaxLevelSize || m_Header.rows > MaxLevelSize) return false;
+
+	m_Buffer.resize(m_BufferSize);
+	m_BufferOffset = 0;
+	m_BufferEnd = 0;
+	m_NextRow = 0;
+	m_Open = true;
+	return true;
+}
+
+bool LevelReader::ReadByte(uint8_t& value)
+{
+	if (m_BufferOffset == m_BufferEnd)
+	{
+		m_File.read(reinterpret_cast<char*>(m_Buffer.data()), static_cast<std::streamsize>(m_Buffer.size()));
+		m_BufferOffset = 0;
+		m_BufferEnd = static_cast<size_t>(m_File.gcount());
+		if (m_BufferEnd == 0) return false;
+	}
+
+	value = m_Buffer[m_BufferOffset++];
+	return true;
+}
+
+bool LevelReader::ReadVarint(uint32_t& value)
+{
+	value = 0;
+	for (int shift { 0 }; shift < 32; shift += 7)
+	{
+		uint8_t byte { 0 };
+		if (!ReadByte(byte)) return false;
+
+		value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+bool LevelReader::ReadRows(BrickField& field, uint32_t maxRows)
+{
+	if (!m_Open) return false;
+
+	if (m_NextRow == 0)
+	{
+		field.Reset(static_cast<int>(m_Header.columns), static_cast<int>(m_Header.rows));
+	}
+
+	auto Fail { [&]() {
+		m_Open = false;
+		m_File.close();
+		return false;
+		} };
+
+	const uint32_t endRow { m_NextRow + std::min(maxRows, m_Header.rows - m_NextRow) };
+	for (; m_NextRow < endRow; m_NextRow++)
+	{
+		uint32_t column { 0 };
+		while (true)
+		{
+			uint32_t skip { 0 };
+			uint32_t count { 0 };
+			if (!ReadVarint(skip) || !ReadVarint(count)) return Fail();
+			if (count == 0) break;
+
+			// Checked one at a time so a huge skip can't wrap around
+			if (skip > m_Header.columns - column || count > m_Header.columns - column - skip) return Fail();
+			column += skip;
+
+			for (uint32_t i { 0 }; i < count; i++, column++)
+			{
+				uint8_t packed { 0 };
+				if (!ReadByte(packed)) return Fail();
+
+				const BrickCell cell { static_cast<uint8_t>(packed >> 4), static_cast<uint8_t>(packed & 0x0F) };
+				if (cell.hitPoints == 0) return Fail();
+				field.Set(static_cast<int>(column), static_cast<int>(m_NextRow), cell);
+			}
+		}
+	}
+
+	if (m_NextRow == m_Header.rows)
+	{
+		m_File.close();
+		if (field.GetLiveCount() != m_Header.brickCount)
+		{
+			m_Open = false;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LoadLevel(const char* path, BrickField& field)
+{
+	LevelReader reader;
+	if (!reader.Open(path)) return false;
+
+	// Zero rows still needs the one call to size the field
+	do
+	{
+		if (!reader.ReadRows(field, 256)) return false;
+	} while (!reader.IsDone());
+
+	return true;
+}
+
+bool SaveLevel(const char* path, const BrickField& field)
+{
+	LevelHeader header;
+	header.columns = static_cast<uint32_t>(field.GetColumns());
+	header.rows = static_cast<uint32_t>(field.GetRows());
+	header.brickCount = field.GetLiveCount();
+
+	std::ofstream output { path, std::ios::binary | std::ios::trunc };
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// One row at a time so a big level is never encoded all at once
+	std::vector<uint8_t> data;
+	std::vector<uint8_t> run;
+	for (int row { 0 }; row < field.GetRows(); row++)
+	{
+		data.clear();
+		int column { 0 };
+		while (column < field.GetColumns())
+		{
+			const int runStart { column };
+			while (column < field.GetColumns() && !field.IsLive(column, row)) column++;
+			if (column == field.GetColumns()) break;
+
+			const int skip { column - runStart };
+			run.clear();
+			for (; column < field.GetColumns() && field.IsLive(column, row); column++)
+			{
+				const BrickCell cell { field.Get(column, row) };
+				run.push_back(static_cast<uint8_t>((cell.type & 0x0F) << 4 | std::min<int>(cell.hitPoints, MaxBrickHitPoints)));
+			}
+
+			WriteVarint(data, static_cast<uint32_t>(skip));
+			WriteVarint(data, static_cast<uint32_t>(run.size()));
+			data.insert(data.end(), run.begin(), run.end());
+		}
+
+		// End of the row
+		WriteVarint(data, 0);
+		WriteVarint(data, 0);
+		output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	return static_cast<bool>(output);
+}
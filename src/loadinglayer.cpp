@@ -0,0 +1,34 @@
+#include "loadinglayer.h"
+#include "application.h"
+#include <algorithm>
+
+bool LoadingLayer::ProcessInput()
+{
+	// Nothing underneath should react while it's loading
+	return true;
+}
+
+void LoadingLayer::Update(float deltaTime)
+{
+}
+
+void LoadingLayer::Draw(float interpolationAlpha)
+{
+	const float progress { std::clamp(Application::Instance().GetTransitionProgress(), 0.0f, 1.0f) };
+
+	constexpr Color backgroundColour { 28, 28, 28, 255 };
+	ClearBackground(backgroundColour);
+
+	const float windowWidth { static_cast<float>(GetScreenWidth()) };
+	const float windowHeight { static_cast<float>(GetScreenHeight()) };
+	const float barWidth { windowWidth * 0.5f };
+	const float barHeight { 8.0f };
+	const Rectangle bar { (windowWidth - barWidth) * 0.5f, (windowHeight - barHeight) * 0.5f, barWidth, barHeight };
+
+	DrawRectangleRec(bar, Color { 48, 48, 48, 255 });
+	DrawRectangleRec({ bar.x, bar.y, bar.width * progress, bar.height }, WHITE);
+
+	constexpr int fontSize { 20 };
+	const int textWidth { MeasureText("loading", fontSize) };
+	DrawText("loading", static_cast<int>((windowWidth - textWidth) * 0.5f), static_cast<int>(bar.y) - fontSize * 2, fontSize, WHITE);
+}
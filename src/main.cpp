@@ -1,10 +1,60 @@
 #include "application.h"
 #include "gamelayer.h"
+#include "loadinglayer.h"
+#include "profilerlayer.h"
+#include <cstring>
 
-int main()
+/*
+* Usage: breakout [--record file] [--replay file] [--level file] [--threaded] [--autoplay]
+* Replays can also be run without a window by breakout_headless --replay.
+* Levels are made by breakout_levelbaker, a replay of one needs the same --level.
+* --threaded steps the simulation on its own thread, see GameLayer::SetThreadedSimulation.
+* --autoplay leaves the game playing itself for soak runs, see GameLayer::StartAutoplay.
+*/
+int main(int argc, char** argv)
 {
+#if defined(BREAKOUT_PROFILER)
+	// Before the GameLayer starts its asset workers so they show up in the trace too
+	Profiler::SetEnabled(true);
+	PROFILE_THREAD("main");
+#endif
+
 	Application& application { Application::Instance() };
-	application.PushLayer<GameLayer>();
+	constexpr float tickRate { 120.0f };
+	application.SetFixedTimestep(tickRate);
+
+	GameOptions options;
+	for (int i { 1 }; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			options.recordPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			options.replayPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			options.levelPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threaded") == 0)
+		{
+			options.threadedTickRate = tickRate;
+		}
+		else if (std::strcmp(argv[i], "--autoplay") == 0)
+		{
+			options.autoplay = true;
+		}
+	}
+
+	// The game is built and loaded behind the loading screen, which fades out over it once it's ready
+	constexpr float loadingFadeSeconds { 0.3f };
+	const LoadingLayer& loadingLayer { application.PushLayer<LoadingLayer>() };
+	application.TransitionLayer<GameLayer>(&loadingLayer, loadingFadeSeconds, options);
+
+#if defined(BREAKOUT_PROFILER)
+	application.PushLayer<ProfilerLayer>();
+#endif
 	application.Run();
 }
-
@@ -0,0 +1,108 @@
+#include "mappedfile.h"
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	m_File = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		m_File = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_Mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_Data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_Size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data != nullptr) UnmapViewOfFile(m_Data);
+	if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+	if (m_File != nullptr) CloseHandle(m_File);
+
+	m_Data = nullptr;
+	m_Mapping = nullptr;
+	m_File = nullptr;
+	m_Size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+	Close();
+
+	const int file { open(path, O_RDONLY) };
+	if (file < 0) return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* data { mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0) };
+
+	// The mapping keeps its own reference to the file
+	close(file);
+
+	if (data == MAP_FAILED) return false;
+
+	m_Data = static_cast<const uint8_t*>(data);
+	m_Size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+	}
+
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+#endif
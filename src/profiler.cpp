@@ -0,0 +1,167 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+/*
+* Events are pushed when a zone ends, so each buffer is already sorted by end time and
+* a reader only has to walk back from the head until it reaches events older than since.
+*/
+void ProfileThreadBuffer::CopyEvents(int64_t since, std::vector<ProfileEvent>& out) const
+{
+	const uint64_t end { head.load(std::memory_order_acquire) };
+	const uint64_t begin { end > m_Capacity ? end - m_Capacity : 0 };
+
+	const size_t first { out.size() };
+	uint64_t index { end };
+	while (index > begin)
+	{
+		const ProfileEvent& event { events[(index - 1) & (m_Capacity - 1)] };
+		if (event.end < since) break;
+
+		out.push_back(event);
+		index--;
+	}
+
+	// The writer kept going while we copied, anything it has come back round to could be torn
+	const uint64_t after { head.load(std::memory_order_acquire) };
+	const uint64_t safeBegin { after > m_Capacity ? after - m_Capacity : 0 };
+	if (safeBegin > index)
+	{
+		const size_t unsafe { static_cast<size_t>(std::min<uint64_t>(safeBegin - index, out.size() - first)) };
+		out.resize(out.size() - unsafe);
+	}
+
+	std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+}
+
+Profiler::Profiler()
+	: m_Epoch { std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() }
+{
+}
+
+Profiler& Profiler::Instance()
+{
+	static Profiler instance;
+	return instance;
+}
+
+int64_t Profiler::Now() const
+{
+	const auto now { std::chrono::steady_clock::now().time_since_epoch() };
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - m_Epoch;
+}
+
+ProfileThreadBuffer& Profiler::RegisterThread()
+{
+	std::lock_guard lock { m_BuffersMutex };
+	m_Buffers.push_back(std::make_unique<ProfileThreadBuffer>());
+
+	ProfileThreadBuffer& buffer { *m_Buffers.back() };
+	buffer.threadIndex = static_cast<uint32_t>(m_Buffers.size() - 1);
+	std::snprintf(buffer.threadName, sizeof(buffer.threadName), "thread %u", buffer.threadIndex);
+	return buffer;
+}
+
+ProfileThreadBuffer& Profiler::GetThreadBuffer()
+{
+	thread_local ProfileThreadBuffer* buffer { nullptr };
+	if (buffer == nullptr)
+	{
+		buffer = &RegisterThread();
+	}
+	return *buffer;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	if (!IsEnabled()) return;
+
+	ProfileThreadBuffer& buffer { GetThreadBuffer() };
+	std::strncpy(buffer.threadName, name, sizeof(buffer.threadName) - 1);
+}
+
+void Profiler::MarkFrame()
+{
+	if (!IsEnabled()) return;
+
+	if (m_MainBuffer == nullptr)
+	{
+		m_MainBuffer = &GetThreadBuffer();
+	}
+
+	m_FrameStarts[m_FrameCount % m_FrameHistory] = Now();
+	m_FrameCount++;
+}
+
+ProfileFrameStats Profiler::GetFrameStats() const
+{
+	ProfileFrameStats stats;
+	const size_t starts { static_cast<size_t>(std::min<uint64_t>(m_FrameCount, m_FrameHistory)) };
+	if (starts < 2) return stats;
+
+	std::array<double, m_FrameHistory> frameTimes;
+	for (size_t i { 0 }; i + 1 < starts; i++)
+	{
+		const uint64_t frame { m_FrameCount - starts + i };
+		const int64_t duration { m_FrameStarts[(frame + 1) % m_FrameHistory] - m_FrameStarts[frame % m_FrameHistory] };
+		frameTimes[i] = static_cast<double>(duration) / 1'000'000.0;
+	}
+
+	const size_t count { starts - 1 };
+	std::sort(frameTimes.begin(), frameTimes.begin() + static_cast<std::ptrdiff_t>(count));
+	stats.p50Ms = frameTimes[count / 2];
+	stats.p99Ms = frameTimes[std::min(count - 1, count * 99 / 100)];
+	stats.maxMs = frameTimes[count - 1];
+	stats.frameCount = count;
+	return stats;
+}
+
+int64_t Profiler::GetHistoryStart() const
+{
+	if (m_FrameCount == 0) return 0;
+
+	const uint64_t oldest { m_FrameCount > m_FrameHistory ? m_FrameCount - m_FrameHistory : 0 };
+	return m_FrameStarts[oldest % m_FrameHistory];
+}
+
+void Profiler::CopyMainThreadEvents(int64_t since, std::vector<ProfileEvent>& out) const
+{
+	if (m_MainBuffer != nullptr)
+	{
+		m_MainBuffer->CopyEvents(since, out);
+	}
+}
+
+bool Profiler::WriteChromeTrace(const char* path) const
+{
+	FILE* file { std::fopen(path, "w") };
+	if (file == nullptr) return false;
+
+	std::lock_guard lock { m_BuffersMutex };
+
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first { true };
+	std::vector<ProfileEvent> events;
+	for (const std::unique_ptr<ProfileThreadBuffer>& buffer : m_Buffers)
+	{
+		std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			first ? "" : ",\n", buffer->threadIndex, buffer->threadName);
+		first = false;
+
+		events.clear();
+		buffer->CopyEvents(0, events);
+		for (const ProfileEvent& event : events)
+		{
+			// Trace timestamps are in microseconds
+			std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				event.name, buffer->threadIndex, event.start / 1000.0, (event.end - event.start) / 1000.0);
+		}
+	}
+	std::fprintf(file, "\n]}\n");
+
+	const bool ok { std::ferror(file) == 0 };
+	std::fclose(file);
+	return ok;
+}
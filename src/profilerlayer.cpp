@@ -0,0 +1,106 @@
+#include "profilerlayer.h"
+#include <algorithm>
+#include <cstring>
+
+bool ProfilerLayer::ProcessInput()
+{
+	if (IsKeyPressed(KEY_F2))
+	{
+		m_ShowOverlay = !m_ShowOverlay;
+		m_FramesUntilRefresh = 0;
+	}
+
+	if (IsKeyPressed(KEY_F4))
+	{
+		const char* path { TextFormat("%sprofile.json", GetApplicationDirectory()) };
+		if (Profiler::Instance().WriteChromeTrace(path))
+		{
+			TraceLog(LOG_INFO, "PROFILER: [%s] Wrote Chrome trace", path);
+		}
+		else
+		{
+			TraceLog(LOG_WARNING, "PROFILER: [%s] Failed to write Chrome trace", path);
+		}
+	}
+
+	// Only looks, the layers below still get the input
+	return false;
+}
+
+void ProfilerLayer::Update(float deltaTime)
+{
+}
+
+void ProfilerLayer::Refresh()
+{
+	Profiler& profiler { Profiler::Instance() };
+	m_FrameStats = profiler.GetFrameStats();
+
+	m_Events.clear();
+	profiler.CopyMainThreadEvents(profiler.GetHistoryStart(), m_Events);
+
+	// Names are string literals so the pointer is nearly always enough, the strcmp catches
+	// the same literal ending up at different addresses in different translation units
+	m_Zones.clear();
+	for (const ProfileEvent& event : m_Events)
+	{
+		auto zone { std::find_if(m_Zones.begin(), m_Zones.end(), [&](const ZoneSummary& summary) {
+			return summary.name == event.name || std::strcmp(summary.name, event.name) == 0;
+			}) };
+
+		if (zone == m_Zones.end())
+		{
+			m_Zones.push_back(ZoneSummary { event.name, 0.0, event.depth });
+			zone = m_Zones.end() - 1;
+		}
+
+		zone->msPerFrame += static_cast<double>(event.end - event.start) / 1'000'000.0;
+		zone->depth = std::min(zone->depth, event.depth);
+	}
+
+	const double frames { static_cast<double>(std::max<size_t>(1, m_FrameStats.frameCount)) };
+	for (ZoneSummary& zone : m_Zones)
+	{
+		zone.msPerFrame /= frames;
+	}
+
+	std::sort(m_Zones.begin(), m_Zones.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+		return a.depth != b.depth ? a.depth < b.depth : a.msPerFrame > b.msPerFrame;
+		});
+}
+
+void ProfilerLayer::Draw(float interpolationAlpha)
+{
+	if (!m_ShowOverlay) return;
+
+	// Twice a second at 60fps
+	constexpr int refreshInterval { 30 };
+	if (m_FramesUntilRefresh-- <= 0)
+	{
+		Refresh();
+		m_FramesUntilRefresh = refreshInterval;
+	}
+
+	constexpr int fontSize { 10 };
+	constexpr int lineHeight { 12 };
+	constexpr int padding { 6 };
+	constexpr int width { 260 };
+	const int height { padding * 2 + lineHeight * (2 + static_cast<int>(m_Zones.size())) };
+	const int x { GetScreenWidth() - width - padding };
+	const int y { padding };
+
+	DrawRectangle(x, y, width, height, Color { 0, 0, 0, 190 });
+
+	int lineY { y + padding };
+	DrawText(TextFormat("frame  p50 %.2f ms  p99 %.2f ms  max %.2f ms", m_FrameStats.p50Ms, m_FrameStats.p99Ms, m_FrameStats.maxMs),
+		x + padding, lineY, fontSize, GREEN);
+	lineY += lineHeight * 2;
+
+	for (const ZoneSummary& zone : m_Zones)
+	{
+		const int indent { static_cast<int>(zone.depth) * 8 };
+		DrawText(zone.name, x + padding + indent, lineY, fontSize, RAYWHITE);
+		DrawText(TextFormat("%.3f ms", zone.msPerFrame), x + width - padding - 60, lineY, fontSize, RAYWHITE);
+		lineY += lineHeight;
+	}
+}
@@ -0,0 +1,89 @@
+#include "raylibaudio.h"
+#include <cmath>
+
+namespace Audio
+{
+	RaylibBackend::~RaylibBackend()
+	{
+		Unload();
+	}
+
+	/*
+	* Resampling to sampleRate / pitch and then labelling the result with the original rate
+	* makes it play back pitch times faster, the same thing SetSoundPitch does but done once
+	* here with the miniaudio converter instead of live on the mixing thread.
+	*/
+	VariantID RaylibBackend::CreateVariant(const Wave& wave, float pitch)
+	{
+		Sound sound { 0 };
+		if (pitch == 1.0f || wave.data == nullptr)
+		{
+			sound = LoadSoundFromWave(wave);
+		}
+		else
+		{
+			Wave resampled { WaveCopy(wave) };
+			const int sampleRate { static_cast<int>(std::lround(wave.sampleRate / pitch)) };
+			WaveFormat(&resampled, sampleRate, static_cast<int>(wave.sampleSize), static_cast<int>(wave.channels));
+			resampled.sampleRate = wave.sampleRate;
+
+			sound = LoadSoundFromWave(resampled);
+			UnloadWave(resampled);
+		}
+
+		m_Variants.push_back(sound);
+		return static_cast<VariantID>(m_Variants.size() - 1);
+	}
+
+	VoiceID RaylibBackend::CreateVoice(VariantID firstVariant, uint32_t variantCount)
+	{
+		m_Voices.push_back(Voice { static_cast<uint32_t>(m_Aliases.size()), -1 });
+		for (uint32_t i { 0 }; i < variantCount; i++)
+		{
+			// LoadSoundAlias doesn't check for a sound that failed to load (no audio device)
+			const Sound& variant { m_Variants[firstVariant + i] };
+			m_Aliases.push_back(variant.stream.buffer != nullptr ? LoadSoundAlias(variant) : Sound { 0 });
+		}
+		return static_cast<VoiceID>(m_Voices.size() - 1);
+	}
+
+	void RaylibBackend::Play(VoiceID voice, uint32_t variant)
+	{
+		Voice& info { m_Voices[voice] };
+		info.playing = static_cast<int32_t>(info.firstAlias + variant);
+		PlaySound(m_Aliases[info.playing]);
+	}
+
+	void RaylibBackend::Stop(VoiceID voice)
+	{
+		Voice& info { m_Voices[voice] };
+		if (info.playing < 0) return;
+
+		StopSound(m_Aliases[info.playing]);
+		info.playing = -1;
+	}
+
+	bool RaylibBackend::IsPlaying(VoiceID voice) const
+	{
+		const Voice& info { m_Voices[voice] };
+		return info.playing >= 0 && IsSoundPlaying(m_Aliases[info.playing]);
+	}
+
+	void RaylibBackend::Unload()
+	{
+		// Aliases point at their variant's buffer so they have to go first
+		for (const Sound& alias : m_Aliases)
+		{
+			UnloadSoundAlias(alias);
+		}
+
+		for (const Sound& sound : m_Variants)
+		{
+			UnloadSound(sound);
+		}
+
+		m_Aliases.clear();
+		m_Variants.clear();
+		m_Voices.clear();
+	}
+};
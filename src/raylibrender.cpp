@@ -0,0 +1,16 @@
+#include "raylibrender.h"
+
+void RaylibRenderBackend::DrawSprite(const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint)
+{
+	DrawTexturePro(texture, source, destination, { 0.0f, 0.0f }, 0.0f, tint);
+}
+
+void RaylibRenderBackend::FillRectangle(const Rectangle& rectangle, Color colour)
+{
+	DrawRectangleRec(rectangle, colour);
+}
+
+void RaylibRenderBackend::DrawTextRun(const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour)
+{
+	DrawTextEx(font, text, position, fontSize, spacing, colour);
+}
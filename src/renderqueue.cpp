@@ -0,0 +1,174 @@
+#include "renderqueue.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cstring>
+
+void RenderQueue::Begin()
+{
+	m_Commands.clear();
+	m_SortKeys.clear();
+	m_TextBuffer.clear();
+}
+
+void RenderQueue::Push(RenderLayer layer, uint16_t depth, const RenderCommand& command)
+{
+	const uint64_t key { (static_cast<uint64_t>(layer) << 56) |
+		(static_cast<uint64_t>(command.texture.id & 0xFFFF) << 40) |
+		(static_cast<uint64_t>(depth) << 24) |
+		(static_cast<uint64_t>(m_Commands.size()) & m_IndexMask) };
+
+	m_SortKeys.push_back(key);
+	m_Commands.push_back(command);
+}
+
+void RenderQueue::PushSprite(RenderLayer layer, const Texture2D& texture, const Rectangle& source, Vector2 position, Color tint, uint16_t depth)
+{
+	PushSprite(layer, texture, source, { position.x, position.y, source.width, source.height }, tint, depth);
+}
+
+void RenderQueue::PushSprite(RenderLayer layer, const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint, uint16_t depth)
+{
+	RenderCommand command;
+	command.type = RenderCommandType::SPRITE;
+	command.tint = tint;
+	command.texture = texture;
+	command.source = source;
+	command.destination = destination;
+	Push(layer, depth, command);
+}
+
+void RenderQueue::PushRectangle(RenderLayer layer, const Rectangle& rectangle, Color colour, uint16_t depth)
+{
+	// Shapes are textured quads too, keying them by the shapes texture lets them batch with
+	// sprites when it has been pointed at a white pixel in the sprite atlas
+	RenderCommand command;
+	command.type = RenderCommandType::RECTANGLE;
+	command.tint = colour;
+	command.texture.id = m_ShapesTexture;
+	command.destination = rectangle;
+	Push(layer, depth, command);
+}
+
+void RenderQueue::PushText(RenderLayer layer, const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour, uint16_t depth)
+{
+	RenderCommand command;
+	command.type = RenderCommandType::TEXT;
+	command.tint = colour;
+	command.texture = font.texture;
+	command.destination = { position.x, position.y, 0.0f, 0.0f };
+	command.font = &font;
+	command.textOffset = static_cast<uint32_t>(m_TextBuffer.size());
+	command.fontSize = fontSize;
+	command.spacing = spacing;
+
+	m_TextBuffer.insert(m_TextBuffer.end(), text, text + std::strlen(text) + 1);
+	Push(layer, depth, command);
+}
+
+void RenderQueue::Submit(RenderBackend& backend)
+{
+	std::sort(m_SortKeys.begin(), m_SortKeys.end());
+
+	m_Stats = RenderStats {};
+	m_Stats.commands = static_cast<int>(m_Commands.size());
+
+	// Mirror what rlgl does with its batch so the counters match what actually reaches GL
+	unsigned int boundTexture { 0 };
+	int batchQuads { 0 };
+	int batchDraws { 0 };
+	auto Track { [&](unsigned int texture, int quads) {
+		if (texture != boundTexture)
+		{
+			boundTexture = texture;
+			m_Stats.drawCalls++;
+			if (++batchDraws >= RL_DEFAULT_BATCH_DRAWCALLS)
+			{
+				m_Stats.batchFlushes++;
+				batchDraws = 1;
+				batchQuads = 0;
+			}
+		}
+
+		batchQuads += quads;
+		if (batchQuads > RL_DEFAULT_BATCH_BUFFER_ELEMENTS)
+		{
+			m_Stats.batchFlushes++;
+			batchQuads = quads;
+			batchDraws = 1;
+		}
+	} };
+
+	for (uint64_t key : m_SortKeys)
+	{
+		const RenderCommand& command { m_Commands[key & m_IndexMask] };
+
+		switch (command.type)
+		{
+		case RenderCommandType::SPRITE:
+		{
+			Track(command.texture.id, 1);
+			backend.DrawSprite(command.texture, command.source, command.destination, command.tint);
+			break;
+		}
+		case RenderCommandType::RECTANGLE:
+		{
+			Track(command.texture.id, 1);
+			backend.FillRectangle(command.destination, command.tint);
+			break;
+		}
+		case RenderCommandType::TEXT:
+		{
+			// One quad per visible glyph, DrawTextEx skips whitespace
+			const char* text { &m_TextBuffer[command.textOffset] };
+			const int glyphs { static_cast<int>(std::count_if(text, text + std::strlen(text),
+				[](char c) { return c != ' ' && c != '\t' && c != '\n'; })) };
+
+			Track(command.texture.id, glyphs);
+			backend.DrawTextRun(*command.font, text, { command.destination.x, command.destination.y }, command.fontSize, command.spacing, command.tint);
+			break;
+		}
+		}
+	}
+
+	// Whatever is left is drawn when the frame ends
+	if (batchQuads > 0)
+	{
+		m_Stats.batchFlushes++;
+	}
+}
+
+uint64_t RenderQueue::GetHash() const
+{
+	uint64_t hash { 14695981039346656037ull };
+	auto Mix { [&](const void* data, size_t size) {
+		const uint8_t* bytes { static_cast<const uint8_t*>(data) };
+		for (size_t i { 0 }; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+		} };
+
+	// Submit sorts the keys in place, a copy leaves the recording as it was
+	std::vector<uint64_t> keys { m_SortKeys };
+	std::sort(keys.begin(), keys.end());
+
+	for (uint64_t key : keys)
+	{
+		const RenderCommand& command { m_Commands[key & m_IndexMask] };
+		const uint64_t order { key & ~m_IndexMask };
+		Mix(&order, sizeof(order));
+		Mix(&command.type, sizeof(command.type));
+		Mix(&command.tint, sizeof(command.tint));
+		Mix(&command.source, sizeof(command.source));
+		Mix(&command.destination, sizeof(command.destination));
+		Mix(&command.fontSize, sizeof(command.fontSize));
+		Mix(&command.spacing, sizeof(command.spacing));
+
+		if (command.type == RenderCommandType::TEXT)
+		{
+			const char* text { &m_TextBuffer[command.textOffset] };
+			Mix(text, std::strlen(text));
+		}
+	}
+	return hash;
+}
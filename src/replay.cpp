@@ -0,0 +1,231 @@
+#include "replay.h"
+#include <bit>
+#include <fstream>
+#include <iterator>
+
+static void WriteVarint(std::vector<uint8_t>& data, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back(static_cast<uint8_t>(value));
+}
+
+static bool ReadVarint(const std::vector<uint8_t>& data, size_t& offset, uint64_t& value)
+{
+	value = 0;
+	for (int shift { 0 }; shift < 64 && offset < data.size(); shift += 7)
+	{
+		const uint8_t byte { data[offset++] };
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+static void WriteFloat(std::vector<uint8_t>& data, float value)
+{
+	const uint32_t bits { std::bit_cast<uint32_t>(value) };
+	for (int i { 0 }; i < 4; i++)
+	{
+		data.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+	}
+}
+
+static bool ReadFloat(const std::vector<uint8_t>& data, size_t& offset, float& value)
+{
+	if (offset + 4 > data.size()) return false;
+
+	uint32_t bits { 0 };
+	for (int i { 0 }; i < 4; i++)
+	{
+		bits |= static_cast<uint32_t>(data[offset++]) << (i * 8);
+	}
+	value = std::bit_cast<float>(bits);
+	return true;
+}
+
+// Compared bit for bit, -0.0 and 0.0 are different inputs as far as replaying exactly goes
+static bool SameFloat(float a, float b)
+{
+	return std::bit_cast<uint32_t>(a) == std::bit_cast<uint32_t>(b);
+}
+
+static bool SameInput(const SimInput& a, const SimInput& b)
+{
+	return SameFloat(a.paddleDirection, b.paddleDirection) && a.confirm == b.confirm && a.spawnBalls == b.spawnBalls;
+}
+
+void ReplayRecorder::Begin(uint32_t seed, const SimLayout& layout, uint32_t levelHash)
+{
+	m_Header = ReplayHeader {};
+	m_Header.seed = seed;
+	m_Header.levelHash = levelHash;
+	m_Header.paddleWidth = layout.paddleWidth;
+	m_Header.paddleHeight = layout.paddleHeight;
+	m_Header.ballWidth = layout.ballWidth;
+	m_Header.ballHeight = layout.ballHeight;
+	m_Header.blockWidth = layout.blockWidth;
+	m_Header.blockHeight = layout.blockHeight;
+
+	m_Data.clear();
+	m_RunLength = 0;
+	m_Recording = true;
+}
+
+void ReplayRecorder::Record(const SimInput& input, float deltaTime)
+{
+	if (!m_Recording) return;
+
+	if (m_RunLength > 0 && (!SameInput(input, m_RunInput) || !SameFloat(deltaTime, m_RunDeltaTime)))
+	{
+		WriteRun();
+		m_RunLength = 0;
+	}
+
+	m_RunInput = input;
+	m_RunDeltaTime = deltaTime;
+	m_RunLength++;
+	m_Header.tickCount++;
+}
+
+void ReplayRecorder::WriteRun()
+{
+	const bool firstRun { m_Data.empty() };
+	const float direction { m_RunInput.paddleDirection };
+
+	uint8_t flags { REPLAY_DIRECTION_RAW };
+	if (SameFloat(direction, 0.0f)) flags = REPLAY_DIRECTION_NONE;
+	else if (direction == -1.0f) flags = REPLAY_DIRECTION_LEFT;
+	else if (direction == 1.0f) flags = REPLAY_DIRECTION_RIGHT;
+
+	if (m_RunInput.confirm) flags |= REPLAY_CONFIRM;
+	if (m_RunInput.spawnBalls != 0) flags |= REPLAY_SPAWN_BALLS;
+	if (firstRun || !SameFloat(m_RunDeltaTime, m_WrittenDeltaTime)) flags |= REPLAY_DELTA_TIME;
+
+	WriteVarint(m_Data, m_RunLength);
+	m_Data.push_back(flags);
+
+	if ((flags & REPLAY_DIRECTION_MASK) == REPLAY_DIRECTION_RAW) WriteFloat(m_Data, direction);
+
+	if (flags & REPLAY_SPAWN_BALLS)
+	{
+		const int32_t count { m_RunInput.spawnBalls };
+		WriteVarint(m_Data, (static_cast<uint32_t>(count) << 1) ^ static_cast<uint32_t>(count >> 31));
+	}
+
+	if (flags & REPLAY_DELTA_TIME)
+	{
+		WriteFloat(m_Data, m_RunDeltaTime);
+		m_WrittenDeltaTime = m_RunDeltaTime;
+	}
+}
+
+bool ReplayRecorder::Save(const char* path)
+{
+	if (!m_Recording) return false;
+
+	if (m_RunLength > 0)
+	{
+		WriteRun();
+		m_RunLength = 0;
+	}
+	m_Recording = false;
+
+	std::ofstream output { path, std::ios::binary | std::ios::trunc };
+	output.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+	output.write(reinterpret_cast<const char*>(m_Data.data()), static_cast<std::streamsize>(m_Data.size()));
+	return static_cast<bool>(output);
+}
+
+bool ReplayPlayer::Load(const char* path)
+{
+	m_Playing = false;
+
+	std::ifstream input { path, std::ios::binary };
+	if (!input) return false;
+
+	input.read(reinterpret_cast<char*>(&m_Header), sizeof(m_Header));
+	if (!input || m_Header.magic != ReplayMagic || m_Header.version != ReplayVersion) return false;
+
+	m_Data.assign(std::istreambuf_iterator<char> { input }, std::istreambuf_iterator<char> {});
+	m_ReadOffset = 0;
+	m_RunTicksLeft = 0;
+	m_TicksPlayed = 0;
+	m_Playing = true;
+	return true;
+}
+
+SimLayout ReplayPlayer::GetLayout() const
+{
+	SimLayout layout;
+	layout.paddleWidth = m_Header.paddleWidth;
+	layout.paddleHeight = m_Header.paddleHeight;
+	layout.ballWidth = m_Header.ballWidth;
+	layout.ballHeight = m_Header.ballHeight;
+	layout.blockWidth = m_Header.blockWidth;
+	layout.blockHeight = m_Header.blockHeight;
+	return layout;
+}
+
+bool ReplayPlayer::ReadRun()
+{
+	if (!ReadVarint(m_Data, m_ReadOffset, m_RunTicksLeft) || m_RunTicksLeft == 0 || m_ReadOffset >= m_Data.size()) return false;
+	const uint8_t flags { m_Data[m_ReadOffset++] };
+
+	switch (flags & REPLAY_DIRECTION_MASK)
+	{
+	case REPLAY_DIRECTION_NONE:
+		m_RunInput.paddleDirection = 0.0f;
+		break;
+	case REPLAY_DIRECTION_LEFT:
+		m_RunInput.paddleDirection = -1.0f;
+		break;
+	case REPLAY_DIRECTION_RIGHT:
+		m_RunInput.paddleDirection = 1.0f;
+		break;
+	case REPLAY_DIRECTION_RAW:
+		if (!ReadFloat(m_Data, m_ReadOffset, m_RunInput.paddleDirection)) return false;
+		break;
+	}
+
+	m_RunInput.confirm = (flags & REPLAY_CONFIRM) != 0;
+
+	m_RunInput.spawnBalls = 0;
+	if (flags & REPLAY_SPAWN_BALLS)
+	{
+		uint64_t zigzag { 0 };
+		if (!ReadVarint(m_Data, m_ReadOffset, zigzag)) return false;
+
+		// Only ever positive when recorded, a negative or huge count means the file is corrupt
+		const int64_t spawnBalls { static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1) };
+		if (spawnBalls < 0 || spawnBalls > ReplayMaxSpawnBalls) return false;
+		m_RunInput.spawnBalls = static_cast<int>(spawnBalls);
+	}
+
+	if (flags & REPLAY_DELTA_TIME)
+	{
+		if (!ReadFloat(m_Data, m_ReadOffset, m_RunDeltaTime)) return false;
+	}
+
+	return true;
+}
+
+bool ReplayPlayer::Next(SimInput& input, float& deltaTime)
+{
+	if (!m_Playing) return false;
+
+	if (m_RunTicksLeft == 0 && (m_TicksPlayed >= m_Header.tickCount || !ReadRun()))
+	{
+		m_Playing = false;
+		return false;
+	}
+
+	m_RunTicksLeft--;
+	m_TicksPlayed++;
+	input = m_RunInput;
+	deltaTime = m_RunDeltaTime;
+	return true;
+}
@@ -0,0 +1,130 @@
+#include "simthread.h"
+#include "profiler.h"
+#include <algorithm>
+
+SimThread::~SimThread()
+{
+	Stop();
+}
+
+void SimThread::Start(const GameState& gameState, float tickLength, TickFunction tick, int maxCatchUpSteps)
+{
+	Stop();
+
+	m_GameState = &gameState;
+	m_Tick = std::move(tick);
+	m_TickLength = tickLength;
+	m_MaxCatchUpSteps = std::max(1, maxCatchUpSteps);
+	m_TickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickLength));
+	m_TickCount = 0;
+	m_LastTickTime = std::chrono::steady_clock::now();
+	m_Events.store(EVENT_NONE, std::memory_order_relaxed);
+
+	// The first frame after starting has something to draw without waiting for a tick
+	Publish();
+	m_Snapshots.Acquire();
+
+	m_Thread = std::jthread { [this](std::stop_token stopToken) { Run(stopToken); } };
+}
+
+void SimThread::Stop()
+{
+	if (!m_Thread.joinable()) return;
+
+	m_Thread.request_stop();
+	m_Thread.join();
+}
+
+void SimThread::Run(std::stop_token stopToken)
+{
+	PROFILE_THREAD("simulation");
+
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point nextTick { m_LastTickTime + m_TickDuration };
+
+	while (!stopToken.stop_requested())
+	{
+		std::this_thread::sleep_until(nextTick);
+
+		// Ticks are due at fixed times rather than a tick after the last one finished, so waking up late doesn't push the rest back
+		const Clock::time_point now { Clock::now() };
+		if (now - nextTick > m_TickDuration * m_MaxCatchUpSteps)
+		{
+			nextTick = now;
+		}
+
+		// Usually one, more if the thread itself was held up (the OS didn't schedule it, a breakpoint)
+		while (nextTick <= now)
+		{
+			PROFILE_ZONE("SimThread::Tick");
+			m_Events.fetch_or(m_Tick(TakeInput(), m_TickLength), std::memory_order_relaxed);
+			m_TickCount++;
+			m_LastTickTime = nextTick;
+			nextTick += m_TickDuration;
+		}
+
+		Publish();
+	}
+}
+
+SimInput SimThread::TakeInput()
+{
+	SimInput input;
+	input.paddleDirection = m_PaddleDirection.load(std::memory_order_relaxed);
+	input.confirm = m_Confirm.exchange(false, std::memory_order_relaxed);
+	input.spawnBalls = m_SpawnBalls.exchange(0, std::memory_order_relaxed);
+	return input;
+}
+
+void SimThread::Publish()
+{
+	PROFILE_ZONE("SimThread::Publish");
+	SimSnapshot& snapshot { m_Snapshots.GetWriteSlot() };
+
+	// Assigning into the slot's vectors reuses their capacity, so after the first few ticks this is just copies
+	snapshot.entities = m_GameState->m_Entities;
+
+	// The slot last held the bricks three publishes ago, almost always they haven't changed since
+	const BrickField& bricks { m_GameState->m_Bricks };
+	if (snapshot.bricks.GetRevision() != bricks.GetRevision() || snapshot.bricks.GetGeneration() != bricks.GetGeneration())
+	{
+		snapshot.bricks = bricks;
+	}
+	else
+	{
+		snapshot.bricks.CopyOffsetsFrom(bricks);
+	}
+
+	snapshot.gameMode = m_GameState->m_GameMode;
+	snapshot.score = m_GameState->m_Score;
+	snapshot.highScore = m_GameState->m_HighScore;
+	snapshot.tick = m_TickCount;
+	snapshot.stepTime = m_LastTickTime;
+
+	m_Snapshots.Publish();
+}
+
+void SimThread::SubmitInput(const SimInput& input)
+{
+	m_PaddleDirection.store(input.paddleDirection, std::memory_order_relaxed);
+	if (input.confirm)
+	{
+		m_Confirm.store(true, std::memory_order_relaxed);
+	}
+
+	if (input.spawnBalls != 0)
+	{
+		m_SpawnBalls.fetch_add(input.spawnBalls, std::memory_order_relaxed);
+	}
+}
+
+uint8_t SimThread::TakeEvents()
+{
+	return m_Events.exchange(EVENT_NONE, std::memory_order_relaxed);
+}
+
+float SimThread::GetInterpolationAlpha(std::chrono::steady_clock::time_point time) const
+{
+	const float sinceStep { std::chrono::duration<float>(time - GetSnapshot().stepTime).count() };
+	return std::clamp(sinceStep / m_TickLength, 0.0f, 1.0f);
+}
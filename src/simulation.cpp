@@ -0,0 +1,848 @@
+#include "simulation.h"
+#include "collision.h"
+#include "globals.h"
+#include "profiler.h"
+#include "raymath.h"
+#include <algorithm>
+#include <cmath>
+
+Simulation::Simulation(GameState& gameState)
+	: m_GameState { gameState }
+{
+}
+
+/*
+* Since this style of game has a minimal amount of entities on the screen at anyone time,
+* I chose not to construct or destruct new entities during gameplay or level resets.
+* Instead, entities remain in memory, and code paths are flagged on/off with the
+* bitmask flags (MOVABLE, VISIBLE, COLLIDABLE, etc.).
+*/
+void Simulation::Init(const SimLayout& layout, uint32_t seed)
+{
+	m_GameState.m_Random.Seed(seed);
+	m_DroppedBallContacts = 0;
+
+	EntityStore& entities { m_GameState.m_Entities };
+	entities.Clear();
+
+	Entity paddle;
+	paddle.AddFlag(EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+	paddle.type =			EntityType::PLAYER;
+	paddle.spriteID =		layout.paddleSpriteID;
+	paddle.width =			layout.paddleWidth;
+	paddle.height =			layout.paddleHeight;
+	paddle.position.x =		(GameResolution::f_Width / 2.0f) - (paddle.width / 2);
+	paddle.position.y =		GameResolution::f_Height - paddle.height - 15;
+	paddle.moveSpeed =		400.0f;
+	m_GameState.m_Paddle = entities.Add(paddle);
+
+	Entity ball;
+	ball.AddFlag(EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+	ball.type =				EntityType::BALL;
+	ball.spriteID =		layout.ballSpriteID;
+	ball.width =			layout.ballWidth;
+	ball.height =			layout.ballHeight;
+	ball.position.x =		(GameResolution::f_Width / 2.0f) - (ball.width / 2);
+	ball.position.y =		paddle.position.y - ball.height - 2;
+	ball.moveSpeed =		300.0f;
+	ball.direction =		{ -0.5f, -1.0f };
+	Vector2Normalize(ball.direction);
+	m_GameState.m_Ball = entities.Add(ball);
+
+	m_GameState.m_BlockWidth	= layout.blockWidth;
+	m_GameState.m_BlockHeight	= layout.blockHeight;
+
+	// Bricks aren't entities, a level file's field is copied in by ResetGame, the classic levels are filled in on the full lattice
+	if (m_Level)
+	{
+		LayoutBricks(*m_Level);
+	}
+	else
+	{
+		m_GameState.m_Bricks.Reset(m_GameState.m_MaxBlocksPerRow, m_GameState.m_NumBlockRows);
+		LayoutBricks(m_GameState.m_Bricks);
+	}
+
+	m_GameState.m_GameMode = GameMode::PAUSED;
+	m_GameState.m_HighScore = 0;
+	ResetGame();
+}
+
+void Simulation::SetLevel(BrickField level)
+{
+	m_Level.reset();
+	if (!level.IsEmpty())
+	{
+		m_Level = std::move(level);
+	}
+}
+
+void Simulation::LayoutBricks(BrickField& bricks) const
+{
+	const float padding { static_cast<float>(m_GameState.m_BlockPadding) };
+	const Vector2 brickSize { static_cast<float>(m_GameState.m_BlockWidth), static_cast<float>(m_GameState.m_BlockHeight) };
+	const float width { bricks.GetColumns() * (brickSize.x + padding) - padding };
+	const float height { bricks.GetRows() * (brickSize.y + padding) - padding };
+
+	// Challenge levels are far bigger than the screen, keep the bricks' shape and leave the bottom half to play in
+	const float maxHeight { GameResolution::f_Height * 0.5f };
+	float scale { 1.0f };
+	if (width > GameResolution::f_Width) scale = GameResolution::f_Width / width;
+	if (height * scale > maxHeight) scale = maxHeight / height;
+
+	const float startX { (GameResolution::f_Width * 0.5f) - (width * scale * 0.5f) };
+	bricks.SetLayout({ startX, m_GameState.m_BlockStartOffset },
+		{ (brickSize.x + padding) * scale, (brickSize.y + padding) * scale },
+		{ brickSize.x * scale, brickSize.y * scale });
+}
+
+void Simulation::FillBricks()
+{
+	BrickField& bricks { m_GameState.m_Bricks };
+	if (m_Level)
+	{
+		bricks.CopyFrom(*m_Level);
+		return;
+	}
+
+	// The classic levels, m_currentBlocksPerRow blocks in the middle of every row. The order matters 0 = top 3 = bottom
+	// Each row is a masked fill of the column window, a couple of chunks rather than a brick at a time
+	bricks.Clear();
+	const int numBlocksToSkip { (m_GameState.m_MaxBlocksPerRow - m_GameState.m_currentBlocksPerRow) / 2 };
+	for (int row { 0 }; row < m_GameState.m_NumBlockRows; row++)
+	{
+		bricks.Fill(numBlocksToSkip, row, m_GameState.m_currentBlocksPerRow, 1, BrickCell { static_cast<uint8_t>(row), 1 });
+	}
+}
+
+// Set up the game for the next game after the player clicks play again
+void Simulation::ResetGame()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+	const size_t paddle { m_GameState.m_Paddle };
+	const size_t firstBall { m_GameState.m_Ball };
+
+	// Reset score
+	m_GameState.m_Score = 0;
+
+	// Reset blocks per row to initial value
+	m_GameState.m_currentBlocksPerRow = 7;
+
+	// Reset paddle to center
+	entities.positions[paddle].x = (GameResolution::f_Width / 2.0f) - (entities.sizes[paddle].x / 2);
+	entities.positions[paddle].y = GameResolution::f_Height - entities.sizes[paddle].y - 15;
+	entities.directions[paddle] = { 0.0f, 0.0f };
+
+	// Any extra multi-ball balls are put away, then the first ball is reset relative to the paddle
+	entities.EachReverse<MovableBalls>([&](size_t ball) {
+		if (ball != firstBall) entities.RemoveFlag(ball, EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+		});
+
+	entities.positions[firstBall].x = (GameResolution::f_Width / 2.0f) - (entities.sizes[firstBall].x / 2);
+	entities.positions[firstBall].y = entities.positions[paddle].y - entities.sizes[firstBall].y - 2;
+	entities.directions[firstBall] = { -0.5f, -1.0f };
+	entities.AddFlag(firstBall, EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+
+	// Refill the bricks for the first level, in place (in case it was still dropping in)
+	FillBricks();
+	m_GameState.m_Bricks.SetOffsetY(0.0f);
+	SnapPreviousPositions();
+}
+
+void Simulation::SnapPreviousPositions()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+	std::copy(entities.positions.begin(), entities.positions.end(), entities.previousPositions.begin());
+	m_GameState.m_Bricks.SnapPreviousOffset();
+}
+
+uint8_t Simulation::Step(const SimInput& input, float deltaTime)
+{
+	PROFILE_ZONE("Simulation::Step");
+	EntityStore& entities { m_GameState.m_Entities };
+	const size_t paddle { m_GameState.m_Paddle };
+
+	m_Events = EVENT_NONE;
+	SnapPreviousPositions();
+
+	entities.directions[paddle].x = input.paddleDirection;
+
+	if (input.confirm)
+	{
+		if (m_GameState.m_GameMode == GameMode::PAUSED)
+		{
+			m_GameState.m_GameMode = GameMode::PLAYING;
+		}
+		else if (m_GameState.m_GameMode == GameMode::GAME_OVER)
+		{
+			ResetGame();
+			m_GameState.m_GameMode = GameMode::PAUSED;
+		}
+	}
+
+	switch (m_GameState.m_GameMode)
+	{
+	case GameMode::PAUSED:
+	{
+		// Update paddle movement
+		const float displacement { entities.moveSpeeds[paddle] * deltaTime };
+		Vector2& paddlePosition { entities.positions[paddle] };
+		paddlePosition.x += entities.directions[paddle].x * displacement;
+		paddlePosition.y += entities.directions[paddle].y * displacement;
+		paddlePosition.x = std::clamp(paddlePosition.x, 0.0f, GameResolution::f_Width - entities.sizes[paddle].x);
+
+		// Make ball stick to paddle, centered above it
+		entities.Each<MovableBalls>([&](size_t ball) {
+			entities.positions[ball].x = paddlePosition.x + (entities.sizes[paddle].x / 2.0f) - (entities.sizes[ball].x / 2.0f);
+			entities.positions[ball].y = paddlePosition.y - entities.sizes[ball].y - 2;
+			});
+
+	}
+	break;
+	case GameMode::PLAYING:
+	{
+		if (input.spawnBalls > 0)
+		{
+			SpawnBalls(input.spawnBalls);
+		}
+
+		UpdateEntities(deltaTime);
+		SweepBalls(deltaTime);
+		HandleCollisions();
+		CheckGameRules();
+	}
+	break;
+	case GameMode::LEVEL_CLEAR:
+	{
+		// Respawn blocks
+		m_GameState.m_currentBlocksPerRow += 2;
+		m_GameState.m_currentBlocksPerRow = std::min(m_GameState.m_currentBlocksPerRow, m_GameState.m_MaxBlocksPerRow);
+		FillBricks();
+
+		// Move the whole field offscreen, UpdateEntities drops it back in
+		BrickField& bricks { m_GameState.m_Bricks };
+		const Rectangle brickArea { bricks.GetArea() };
+		bricks.SetOffsetY(-(brickArea.y + brickArea.height + bricks.GetBrickSize().y));
+		SnapPreviousPositions();
+		m_GameState.m_GameMode = GameMode::PLAYING;
+	}
+	break;
+	case GameMode::GAME_OVER:
+	{
+
+	}
+	break;
+	}
+
+	return m_Events;
+}
+
+void Simulation::SpawnBalls(int count)
+{
+	EntityStore& entities { m_GameState.m_Entities };
+
+	// The first ball is the template for the rest
+	if (count <= 0) return;
+	const size_t firstBall { m_GameState.m_Ball };
+	const Vector2 size { entities.sizes[firstBall] };
+
+	const BrickField& bricks { m_GameState.m_Bricks };
+	const Rectangle brickArea { bricks.GetArea() };
+	const float blockFieldBottom { brickArea.y + brickArea.height + (bricks.GetPitch().y - bricks.GetBrickSize().y) };
+	const float paddleTop { entities.positions[m_GameState.m_Paddle].y };
+
+	auto Launch { [&](size_t ball) {
+		entities.positions[ball] = {
+			m_GameState.m_Random.Range(0.0f, GameResolution::f_Width - size.x),
+			m_GameState.m_Random.Range(blockFieldBottom, paddleTop - size.y * 3.0f)
+		};
+		entities.previousPositions[ball] = entities.positions[ball];
+		entities.directions[ball] = Vector2Normalize({ m_GameState.m_Random.Range(-1.0f, 1.0f), -1.0f });
+		entities.AddFlag(ball, EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+		} };
+
+	// Reuse balls that were lost first.
+	// Launching one takes it out of the spares, the back one so nothing has to be swapped into its place
+	for (; count > 0 && entities.Count<SpareBalls>() > 0; count--)
+	{
+		Launch(entities.Indices<SpareBalls>().back());
+	}
+
+	if (count > 0)
+	{
+		Entity ball;
+		ball.type =			EntityType::BALL;
+		ball.spriteID =	entities.spriteIDs[firstBall];
+		ball.width =		static_cast<int>(size.x);
+		ball.height =		static_cast<int>(size.y);
+		ball.moveSpeed =	entities.moveSpeeds[firstBall];
+
+		for (; count > 0; count--)
+		{
+			Launch(entities.Add(ball));
+		}
+	}
+}
+
+int Simulation::GetActiveBallCount() const
+{
+	return static_cast<int>(m_GameState.m_Entities.Count<MovableBalls>());
+}
+
+void Simulation::UpdateEntities(float deltaTime)
+{
+	PROFILE_ZONE("Simulation::UpdateEntities");
+	EntityStore& entities { m_GameState.m_Entities };
+	const size_t paddle { m_GameState.m_Paddle };
+
+	// Handle the brick field dropping in after a level clear
+	BrickField& bricks { m_GameState.m_Bricks };
+	if (bricks.GetOffsetY() != 0.0f)
+	{
+		constexpr float lerpSpeed { 1.5f };
+		// The lerp only gets there asymptotically and stalls a fraction of a pixel short
+		// once the step is below float precision, so snap when it's close enough
+		constexpr float settleDistance { 0.05f };
+		float offsetY { Lerp(bricks.GetOffsetY(), 0.0f, lerpSpeed * deltaTime) };
+
+		if (fabs(offsetY) <= settleDistance)
+		{
+			offsetY = 0.0f;
+		}
+		bricks.SetOffsetY(offsetY);
+	}
+
+	// Update movement, balls are moved by SweepBalls
+	if (entities.HasFlag(paddle, EntityFlags::MOVABLE))
+	{
+		const float displacement { entities.moveSpeeds[paddle] * deltaTime };
+		entities.positions[paddle].x += entities.directions[paddle].x * displacement;
+		entities.positions[paddle].y += entities.directions[paddle].y * displacement;
+	}
+
+	entities.positions[paddle].x = std::clamp(entities.positions[paddle].x, 0.0f, GameResolution::f_Width - entities.sizes[paddle].x);
+}
+
+void Simulation::SweepBalls(float deltaTime)
+{
+	PROFILE_ZONE("Simulation::SweepBalls");
+	EntityStore& entities { m_GameState.m_Entities };
+	const Rectangle paddleBounds { entities.GetCollider(m_GameState.m_Paddle) };
+	const BrickField& bricks { m_GameState.m_Bricks };
+
+	enum class Impact
+	{
+		NONE,
+		WALL,
+		PADDLE,
+		BLOCK
+	};
+
+	// Blocks hit within this fraction of each other count as simultaneous (the ball hitting the seam between two)
+	constexpr float simultaneousHitTime { 1e-4f };
+	// Leave the ball this far off the surface it hit so it never starts the next sweep overlapping
+	constexpr float contactOffset { 1e-3f };
+	constexpr size_t maxSimultaneousBlocks { 4 };
+
+	for (const uint32_t ball : entities.Indices<MovableBalls>())
+	{
+		Vector2& position { entities.positions[ball] };
+		Vector2& direction { entities.directions[ball] };
+		const Vector2 size { entities.sizes[ball] };
+		float remaining { 1.0f };
+
+		for (int impactCount { 0 }; impactCount < m_MaxBallImpactsPerStep && remaining > 0.0f; impactCount++)
+		{
+			const Rectangle ballBounds { entities.GetCollider(ball) };
+			const float distance { entities.moveSpeeds[ball] * deltaTime * remaining };
+			const Vector2 displacement { direction.x * distance, direction.y * distance };
+
+			SweepHit earliest;
+			Impact impact { Impact::NONE };
+			BrickCoord hitBlocks[maxSimultaneousBlocks];
+			size_t hitBlockCount { 0 };
+
+			// Walls, the bottom is open so the ball can fall out
+			if (displacement.x < 0.0f)
+			{
+				const float time { -position.x / displacement.x };
+				if (time >= 0.0f && time < earliest.time)
+				{
+					earliest = { time, { 1.0f, 0.0f } };
+					impact = Impact::WALL;
+				}
+			}
+			else if (displacement.x > 0.0f)
+			{
+				const float time { (GameResolution::f_Width - size.x - position.x) / displacement.x };
+				if (time >= 0.0f && time < earliest.time)
+				{
+					earliest = { time, { -1.0f, 0.0f } };
+					impact = Impact::WALL;
+				}
+			}
+
+			if (displacement.y < 0.0f)
+			{
+				const float time { -position.y / displacement.y };
+				if (time >= 0.0f && time < earliest.time)
+				{
+					earliest = { time, { 0.0f, 1.0f } };
+					impact = Impact::WALL;
+				}
+			}
+
+			SweepHit paddleHit;
+			if (SweepAABB(ballBounds, displacement, paddleBounds, paddleHit) && paddleHit.time < earliest.time)
+			{
+				earliest = paddleHit;
+				impact = Impact::PADDLE;
+			}
+
+			// Only the cells covered by the whole sweep can be hit
+			const Rectangle sweptBounds {
+				std::min(position.x, position.x + displacement.x),
+				std::min(position.y, position.y + displacement.y),
+				size.x + std::abs(displacement.x),
+				size.y + std::abs(displacement.y)
+			};
+
+			bricks.ForEachLiveCell(bricks.ToFieldSpace(sweptBounds), [&](int column, int row) {
+				SweepHit hit;
+				if (!SweepAABB(ballBounds, displacement, bricks.GetBrickBounds(column, row), hit)) return;
+
+				if (hit.time < earliest.time - simultaneousHitTime)
+				{
+					earliest = hit;
+					impact = Impact::BLOCK;
+					hitBlocks[0] = BrickCoord { column, row };
+					hitBlockCount = 1;
+				}
+				else if (impact == Impact::BLOCK && hit.time <= earliest.time + simultaneousHitTime &&
+					hit.normal.x == earliest.normal.x && hit.normal.y == earliest.normal.y &&
+					hitBlockCount < maxSimultaneousBlocks)
+				{
+					hitBlocks[hitBlockCount++] = BrickCoord { column, row };
+				}
+			});
+
+			if (impact == Impact::NONE)
+			{
+				position.x += displacement.x;
+				position.y += displacement.y;
+				break;
+			}
+
+			// Move up to the point of contact and spend the rest of the step after the bounce
+			position.x += displacement.x * earliest.time + earliest.normal.x * contactOffset;
+			position.y += displacement.y * earliest.time + earliest.normal.y * contactOffset;
+			remaining *= (1.0f - earliest.time);
+
+			switch (impact)
+			{
+			case Impact::WALL:
+			{
+				if (earliest.normal.x != 0.0f) direction.x *= -1.0f;
+				if (earliest.normal.y != 0.0f) direction.y *= -1.0f;
+				position.x = std::clamp(position.x, 0.0f, GameResolution::f_Width - size.x);
+				position.y = std::max(0.0f, position.y);
+				m_Events |= EVENT_WALL_HIT;
+			}
+			break;
+			case Impact::PADDLE:
+			{
+				direction = PaddleBounceDirection(entities.GetCollider(ball), paddleBounds);
+				m_Events |= EVENT_PADDLE_HIT;
+			}
+			break;
+			case Impact::BLOCK:
+			{
+				for (size_t i { 0 }; i < hitBlockCount; i++)
+				{
+					HitBrick(hitBlocks[i]);
+				}
+
+				if (earliest.normal.x != 0.0f) direction.x *= -1.0f;
+				if (earliest.normal.y != 0.0f) direction.y *= -1.0f;
+			}
+			break;
+			case Impact::NONE:
+			break;
+			}
+		}
+	}
+}
+
+// Every hit bounces the ball, only the one that breaks the brick scores
+void Simulation::HitBrick(BrickCoord brick)
+{
+	m_Events |= EVENT_BLOCK_HIT;
+	if (m_GameState.m_Bricks.Hit(brick.column, brick.row))
+	{
+		m_GameState.m_Score += 50;
+	}
+}
+
+Vector2 Simulation::PaddleBounceDirection(const Rectangle& ballBounds, const Rectangle& paddleBounds) const
+{
+	// Get how far from the paddle centre the ball hit, normalised by the paddle width
+	const float paddleCenterX { paddleBounds.x + paddleBounds.width * 0.5f };
+	const float ballCenterX { ballBounds.x + ballBounds.width * 0.5f };
+	const float normalisedX { (ballCenterX - paddleCenterX) / (paddleBounds.width * 0.5f) };
+
+	// Scale to make the bounce flatter
+	const float deflection { normalisedX * 1.5f };
+
+	// The y component always shoot us in the opposite y direction
+	return Vector2Normalize({ deflection, -1.0f });
+}
+
+void Simulation::HandleCollisions()
+{
+	PROFILE_ZONE("Simulation::HandleCollisions");
+	HandleBallCollisions();
+	HandleWallCollisions();
+	HandleBlockCollisions();
+	HandlePaddleCollisions();
+}
+
+void Simulation::HandleBallCollisions()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+	std::vector<Vector2>& positions { entities.positions };
+
+	const size_t ballCount { entities.Count<CollidableBalls>() };
+	if (ballCount < 2) return;
+
+	// Cells a ball across, so a ball's bounds only reach into the cells right of and below its own
+	float cellSize { 1.0f };
+	entities.Each<CollidableBalls>([&](size_t ball) {
+		cellSize = std::max({ cellSize, entities.sizes[ball].x, entities.sizes[ball].y });
+		});
+
+	const int columns { static_cast<int>(std::ceil(GameResolution::f_Width / cellSize)) };
+	const int rows { static_cast<int>(std::ceil(GameResolution::f_Height / cellSize)) };
+	const float inverseCellSize { 1.0f / cellSize };
+
+	// Only the occupied cells are ever touched after this, so a step with a few balls doesn't pay for the whole grid
+	const size_t cellCount { static_cast<size_t>(columns) * rows };
+	if (m_BallGridCounts.size() != cellCount)
+	{
+		m_BallGridCounts.assign(cellCount, 0);
+		m_BallGridStarts.assign(cellCount, 0);
+	}
+
+	// Anything off the playfield goes in the edge cells, clamping never pulls two cells further apart.
+	// Clamped first so truncating is flooring, without SSE4.1 std::floor is a call
+	const float lastColumn { static_cast<float>(columns - 1) };
+	const float lastRow { static_cast<float>(rows - 1) };
+	m_BallGridCells.clear();
+	m_BallGridOccupied.clear();
+	entities.Each<CollidableBalls>([&](size_t ball) {
+		const int column { static_cast<int>(std::clamp(positions[ball].x * inverseCellSize, 0.0f, lastColumn)) };
+		const int row { static_cast<int>(std::clamp(positions[ball].y * inverseCellSize, 0.0f, lastRow)) };
+		const uint32_t cell { static_cast<uint32_t>(row * columns + column) };
+		m_BallGridCells.push_back(cell);
+		if (m_BallGridCounts[cell]++ == 0) m_BallGridOccupied.push_back(cell);
+		});
+
+	// Cells are laid out in the order balls first landed in them, the balls of each in entity order,
+	// so the pairs come out in the same order run to run
+	uint32_t nextStart { 0 };
+	for (const uint32_t cell : m_BallGridOccupied)
+	{
+		m_BallGridStarts[cell] = nextStart;
+		nextStart += m_BallGridCounts[cell];
+	}
+
+	m_BallGridEntries.resize(ballCount);
+	size_t nextBall { 0 };
+	entities.Each<CollidableBalls>([&](size_t ball) {
+		const Rectangle bounds { entities.GetCollider(ball) };
+		const uint32_t slot { m_BallGridStarts[m_BallGridCells[nextBall++]]++ };
+		m_BallGridEntries[slot] = { bounds.x, bounds.x + bounds.width, bounds.y, bounds.y + bounds.height, static_cast<uint32_t>(ball), 0 };
+		});
+
+	// The fill moved each start along by the cell's count
+	for (const uint32_t cell : m_BallGridOccupied)
+	{
+		m_BallGridStarts[cell] -= m_BallGridCounts[cell];
+	}
+
+	auto Overlaps { [](const BallGridEntry& entryA, const BallGridEntry& entryB) {
+		return entryB.minX < entryA.maxX && entryB.maxX > entryA.minX && entryB.minY < entryA.maxY && entryB.maxY > entryA.minY;
+		} };
+
+	auto Resolve { [&](BallGridEntry& entryA, BallGridEntry& entryB) {
+		if (!Overlaps(entryA, entryB)) return;
+		if (entryB.contacts >= m_MaxBallContactsPerStep)
+		{
+			m_DroppedBallContacts++;
+			return;
+		}
+		entryA.contacts++;
+		entryB.contacts++;
+
+		const uint32_t a { entryA.ball };
+		const uint32_t b { entryB.ball };
+
+		// Separate along the axis with the least overlap and swap the balls' velocity on that axis
+		const float overlapX { std::min(entryA.maxX, entryB.maxX) - std::max(entryA.minX, entryB.minX) };
+		const float overlapY { std::min(entryA.maxY, entryB.maxY) - std::max(entryA.minY, entryB.minY) };
+
+		Vector2& directionA { entities.directions[a] };
+		Vector2& directionB { entities.directions[b] };
+		const float speedA { Vector2Length(directionA) };
+		const float speedB { Vector2Length(directionB) };
+
+		if (overlapX < overlapY)
+		{
+			const float side { (entryB.minX + entryB.maxX) < (entryA.minX + entryA.maxX) ? -1.0f : 1.0f };
+			const float push { side * overlapX * 0.5f };
+			positions[a].x -= push;
+			positions[b].x += push;
+			entryA.minX -= push;
+			entryA.maxX -= push;
+			entryB.minX += push;
+			entryB.maxX += push;
+
+			// Only bounce if they are moving towards each other
+			if ((directionA.x - directionB.x) * side > 0.0f)
+			{
+				std::swap(directionA.x, directionB.x);
+			}
+		}
+		else
+		{
+			const float side { (entryB.minY + entryB.maxY) < (entryA.minY + entryA.maxY) ? -1.0f : 1.0f };
+			const float push { side * overlapY * 0.5f };
+			positions[a].y -= push;
+			positions[b].y += push;
+			entryA.minY -= push;
+			entryA.maxY -= push;
+			entryB.minY += push;
+			entryB.maxY += push;
+
+			if ((directionA.y - directionB.y) * side > 0.0f)
+			{
+				std::swap(directionA.y, directionB.y);
+			}
+		}
+
+		// Keep each ball at the speed it had, only the heading changes
+		directionA = Vector2Scale(Vector2Normalize(directionA), speedA);
+		directionB = Vector2Scale(Vector2Normalize(directionB), speedB);
+		} };
+
+	// Ball i against entries first to last. Once it's at the cap the rest are only tested to count the ones dropped
+	auto ResolveAgainst { [&](uint32_t i, uint32_t first, uint32_t last) {
+		BallGridEntry& entryA { m_BallGridEntries[i] };
+		uint32_t j { first };
+		for (; j < last && entryA.contacts < m_MaxBallContactsPerStep; j++)
+		{
+			Resolve(entryA, m_BallGridEntries[j]);
+		}
+
+		uint32_t dropped { 0 };
+		for (; j < last; j++)
+		{
+			dropped += Overlaps(entryA, m_BallGridEntries[j]);
+		}
+		m_DroppedBallContacts += dropped;
+		} };
+
+	// Every pair of touching cells once: a cell against itself, then the cells right, below left, below and below right.
+	// Only the cells with balls in, in the order the balls first landed in them so it's the same run to run
+	constexpr int neighbourOffsets[][2] { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+	for (const uint32_t cell : m_BallGridOccupied)
+	{
+		const int row { static_cast<int>(cell) / columns };
+		const int column { static_cast<int>(cell) % columns };
+		const uint32_t first { m_BallGridStarts[cell] };
+		const uint32_t last { first + m_BallGridCounts[cell] };
+
+		for (uint32_t i { first }; i < last; i++)
+		{
+			ResolveAgainst(i, i + 1, last);
+		}
+
+		for (const auto& [offsetColumn, offsetRow] : neighbourOffsets)
+		{
+			const int neighbourColumn { column + offsetColumn };
+			const int neighbourRow { row + offsetRow };
+			if (neighbourColumn < 0 || neighbourColumn >= columns || neighbourRow >= rows) continue;
+
+			const size_t neighbour { static_cast<size_t>(neighbourRow) * columns + neighbourColumn };
+			const uint32_t neighbourFirst { m_BallGridStarts[neighbour] };
+			const uint32_t neighbourLast { neighbourFirst + m_BallGridCounts[neighbour] };
+			for (uint32_t i { first }; i < last; i++)
+			{
+				ResolveAgainst(i, neighbourFirst, neighbourLast);
+			}
+		}
+	}
+
+	// Leave the grid empty for the next step
+	for (const uint32_t cell : m_BallGridOccupied)
+	{
+		m_BallGridCounts[cell] = 0;
+	}
+}
+
+void Simulation::HandleWallCollisions()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+
+	// Check Collisions with wall
+	for (const uint32_t ball : entities.Indices<CollidableBalls>())
+	{
+		Vector2& position { entities.positions[ball] };
+		Vector2& direction { entities.directions[ball] };
+		const Vector2 size { entities.sizes[ball] };
+
+		// Screen Bouncing, only when heading into the wall so a ball the sweep already bounced isn't flipped back
+		if ((position.x <= 0 && direction.x < 0.0f) || (position.x + size.x >= GameResolution::f_Width && direction.x > 0.0f))
+		{
+			direction.x *= -1.0f;
+			position.x = std::clamp(position.x, 0.0f, GameResolution::f_Width - size.x);
+			m_Events |= EVENT_WALL_HIT;
+		}
+
+		if (position.y <= 0 && direction.y < 0.0f)
+		{
+			direction.y *= -1.0f;
+			position.y = std::max(0.0f, position.y);
+			m_Events |= EVENT_WALL_HIT;
+		}
+	}
+}
+
+void Simulation::HandleBlockCollisions()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+	const BrickField& bricks { m_GameState.m_Bricks };
+
+	// Check ball collision vs the live bricks in the cells the ball covers
+	for (const uint32_t ball : entities.Indices<CollidableBalls>())
+	{
+		Rectangle ballBounds { entities.GetCollider(ball) };
+		bool hasCollided { false };
+
+		// Only the bricks the ball overlaps, not the ones it's just in the padding of
+		bricks.ForEachTouchingBrick(bricks.ToFieldSpace(ballBounds), [&](int column, int row) {
+			Rectangle blockBounds { bricks.GetBrickBounds(column, row) };
+
+			HitBrick(BrickCoord { column, row });
+
+			// Ensure the ball flips direction only once in the case of the ball hitting inbetween two blocks
+			if (!hasCollided)
+			{
+				// Calculate ball and block centers
+				float ballCenterX { ballBounds.x + ballBounds.width * 0.5f };
+				float ballCenterY { ballBounds.y + ballBounds.height * 0.5f };
+				float blockCenterX { blockBounds.x + blockBounds.width * 0.5f };
+				float blockCenterY { blockBounds.y + blockBounds.height * 0.5f };
+
+				// Get direciton from block centre to the ball centre
+				float deltaX { ballCenterX - blockCenterX };
+				float deltaY { ballCenterY - blockCenterY };
+
+				// Normalise by block dimensions to get aspect-ratio-independent comparison
+				float normalisedX { deltaX / (blockBounds.width * 0.5f) };
+				float normalisedY { deltaY / (blockBounds.height * 0.5f) };
+
+				// The component with the larger absolute normalised value indicates which side was hit
+				if (std::abs(normalisedX) > std::abs(normalisedY))
+				{
+					// Hit left or right side
+					entities.directions[ball].x *= -1.0f;
+				}
+				else
+				{
+					// Hit top or bottom
+					entities.directions[ball].y *= -1.0f;
+				}
+
+				hasCollided = true;
+			}
+		});
+	}
+}
+
+void Simulation::HandlePaddleCollisions()
+{
+	EntityStore& entities { m_GameState.m_Entities };
+	const Rectangle paddleBounds { entities.GetCollider(m_GameState.m_Paddle) };
+
+	for (const uint32_t ball : entities.Indices<CollidableBalls>())
+	{
+		Rectangle ballBounds { entities.GetCollider(ball) };
+
+		if (CheckCollisionAABB(ballBounds, paddleBounds))
+		{
+			m_Events |= EVENT_PADDLE_HIT;
+			entities.directions[ball] = PaddleBounceDirection(ballBounds, paddleBounds);
+
+			// Calculate collision centers
+			float paddleCenterX { paddleBounds.x + paddleBounds.width * 0.5f };
+			float ballCenterX { ballBounds.x + ballBounds.width * 0.5f };
+			float paddleCenterY { paddleBounds.y + paddleBounds.height * 0.5f };
+			float ballCenterY { ballBounds.y + ballBounds.height * 0.5f };
+
+			// Get direction from paddle centre to the ball centre
+			float deltaX { ballCenterX - paddleCenterX };
+			float deltaY { ballCenterY - paddleCenterY };
+
+			// Normalise by paddle dimensions to get aspect-ratio-independent comparison
+			float normalisedX { deltaX / (paddleBounds.width * 0.5f) };
+			float normalisedY { deltaY / (paddleBounds.height * 0.5f) };
+
+			// If its a side hit snap x position to side to prevent overlap
+			if (std::abs(normalisedX) >= std::abs(normalisedY))
+			{
+				if (deltaX < 0)
+				{
+					// Left side
+					entities.positions[ball].x = paddleBounds.x - ballBounds.width;
+				}
+				else
+				{
+					// Right side
+					entities.positions[ball].x = paddleBounds.x + paddleBounds.width;
+				}
+
+			}
+		}
+	}
+}
+
+void Simulation::CheckGameRules()
+{
+	PROFILE_ZONE("Simulation::CheckGameRules");
+	EntityStore& entities { m_GameState.m_Entities };
+
+	// Balls that fall out the bottom are lost, it's game over once the last one is gone
+	bool ballLost { false };
+	entities.EachReverse<MovableBalls>([&](size_t ball) {
+		if (entities.positions[ball].y >= GameResolution::f_Height)
+		{
+			entities.RemoveFlag(ball, EntityFlags::MOVABLE | EntityFlags::VISIBLE | EntityFlags::COLLIDABLE);
+			ballLost = true;
+		}
+		});
+
+	if (ballLost && GetActiveBallCount() == 0)
+	{
+		m_Events |= EVENT_GAME_OVER;
+		m_GameState.m_HighScore = std::max(m_GameState.m_Score, m_GameState.m_HighScore);
+		m_GameState.m_GameMode = GameMode::GAME_OVER;
+	}
+
+	// Check for level completion, the field keeps count of its live bricks
+	if (m_GameState.m_Bricks.IsEmpty())
+	{
+		m_GameState.m_Score += 250;
+		m_Events |= EVENT_LEVEL_COMPLETE;
+		m_GameState.m_GameMode = GameMode::LEVEL_CLEAR;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,424 @@
+#include "softwarerenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+	#define SOFTWARE_BLIT_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SOFTWARE_BLIT_SSE2
+#endif
+
+static_assert(sizeof(Color) == 4);
+
+/*
+* x / 255 rounded to nearest, exact for anything up to 255 * 255. This is what keeps the
+* blend the same whichever blitter runs it, the vector versions below are the same steps.
+*/
+static inline uint32_t Div255(uint32_t x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+static inline Color BlendPixel(Color destination, Color source, Color tint)
+{
+	source.r = static_cast<unsigned char>(Div255(source.r * tint.r));
+	source.g = static_cast<unsigned char>(Div255(source.g * tint.g));
+	source.b = static_cast<unsigned char>(Div255(source.b * tint.b));
+	source.a = static_cast<unsigned char>(Div255(source.a * tint.a));
+
+	// BLEND_ALPHA for every channel, alpha ends up as sa * sa + da * (1 - sa) the same as in GL
+	const uint32_t alpha { source.a };
+	const uint32_t inverse { 255 - alpha };
+	return Color {
+		static_cast<unsigned char>(Div255(source.r * alpha + destination.r * inverse)),
+		static_cast<unsigned char>(Div255(source.g * alpha + destination.g * inverse)),
+		static_cast<unsigned char>(Div255(source.b * alpha + destination.b * inverse)),
+		static_cast<unsigned char>(Div255(source.a * alpha + destination.a * inverse))
+	};
+}
+
+#if defined(SOFTWARE_BLIT_AVX2)
+static inline __m256i Div255(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+// Two pixels per 128 bit lane, four 16 bit channels each
+static inline __m256i BlendChannels(__m256i destination, __m256i source, __m256i tint, bool tinted)
+{
+	if (tinted) source = Div255(_mm256_mullo_epi16(source, tint));
+
+	const __m256i alpha { _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(source, 0xFF), 0xFF) };
+	const __m256i inverse { _mm256_sub_epi16(_mm256_set1_epi16(255), alpha) };
+	return Div255(_mm256_add_epi16(_mm256_mullo_epi16(source, alpha), _mm256_mullo_epi16(destination, inverse)));
+}
+#elif defined(SOFTWARE_BLIT_SSE2)
+static inline __m128i Div255(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static inline __m128i BlendChannels(__m128i destination, __m128i source, __m128i tint, bool tinted)
+{
+	if (tinted) source = Div255(_mm_mullo_epi16(source, tint));
+
+	const __m128i alpha { _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF) };
+	const __m128i inverse { _mm_sub_epi16(_mm_set1_epi16(255), alpha) };
+	return Div255(_mm_add_epi16(_mm_mullo_epi16(source, alpha), _mm_mullo_epi16(destination, inverse)));
+}
+#endif
+
+/*
+* Tints and blends a row of texels over the framebuffer. With an opaque tint a run of fully
+* opaque texels is just copied and a fully transparent one skipped, which is most of a
+* pixel art sprite. Both give exactly what blending them would, so they aren't a special case
+* as far as the output goes.
+*/
+static void BlendRow(Color* destination, const Color* source, size_t count, Color tint)
+{
+	const bool tinted { tint.r != 255 || tint.g != 255 || tint.b != 255 || tint.a != 255 };
+	size_t i { 0 };
+
+#if defined(SOFTWARE_BLIT_AVX2)
+	const __m256i zero { _mm256_setzero_si256() };
+	const __m256i alphaMask { _mm256_set1_epi32(static_cast<int>(0xFF000000)) };
+	const __m256i tint16 { _mm256_set_epi16(tint.a, tint.b, tint.g, tint.r, tint.a, tint.b, tint.g, tint.r,
+		tint.a, tint.b, tint.g, tint.r, tint.a, tint.b, tint.g, tint.r) };
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i texels { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)) };
+		if (tint.a == 255)
+		{
+			const __m256i alpha { _mm256_and_si256(texels, alphaMask) };
+			if (!tinted && _mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, alphaMask)) == -1)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), texels);
+				continue;
+			}
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, zero)) == -1) continue;
+		}
+
+		const __m256i pixels { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i)) };
+		const __m256i low { BlendChannels(_mm256_unpacklo_epi8(pixels, zero), _mm256_unpacklo_epi8(texels, zero), tint16, tinted) };
+		const __m256i high { BlendChannels(_mm256_unpackhi_epi8(pixels, zero), _mm256_unpackhi_epi8(texels, zero), tint16, tinted) };
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+	}
+#elif defined(SOFTWARE_BLIT_SSE2)
+	const __m128i zero { _mm_setzero_si128() };
+	const __m128i alphaMask { _mm_set1_epi32(static_cast<int>(0xFF000000)) };
+	const __m128i tint16 { _mm_set_epi16(tint.a, tint.b, tint.g, tint.r, tint.a, tint.b, tint.g, tint.r) };
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i texels { _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)) };
+		if (tint.a == 255)
+		{
+			const __m128i alpha { _mm_and_si128(texels, alphaMask) };
+			if (!tinted && _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xFFFF)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), texels);
+				continue;
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF) continue;
+		}
+
+		const __m128i pixels { _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i)) };
+		const __m128i low { BlendChannels(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(texels, zero), tint16, tinted) };
+		const __m128i high { BlendChannels(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(texels, zero), tint16, tinted) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+	}
+#endif
+
+	// Whatever doesn't fill a full vector
+	for (; i < count; i++)
+	{
+		if (tint.a == 255 && source[i].a == 0) continue;
+		destination[i] = BlendPixel(destination[i], source[i], tint);
+	}
+}
+
+/*
+* A translucent rectangle, the same blend as BlendRow with one colour for every texel.
+* The colour's side of the blend is worked out once up front, e.g. the pause overlay is the
+* whole screen.
+*/
+static void BlendColourRow(Color* destination, size_t count, Color colour)
+{
+	const uint32_t alpha { colour.a };
+	const uint32_t inverse { 255 - alpha };
+	size_t i { 0 };
+
+#if defined(SOFTWARE_BLIT_AVX2)
+	const __m256i zero { _mm256_setzero_si256() };
+	const __m256i inverse16 { _mm256_set1_epi16(static_cast<short>(inverse)) };
+	const __m256i premultiplied { _mm256_set_epi16(
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha),
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha),
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha),
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha)) };
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i pixels { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(destination + i)) };
+		const __m256i low { Div255(_mm256_add_epi16(premultiplied, _mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), inverse16))) };
+		const __m256i high { Div255(_mm256_add_epi16(premultiplied, _mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), inverse16))) };
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_packus_epi16(low, high));
+	}
+#elif defined(SOFTWARE_BLIT_SSE2)
+	const __m128i zero { _mm_setzero_si128() };
+	const __m128i inverse16 { _mm_set1_epi16(static_cast<short>(inverse)) };
+	const __m128i premultiplied { _mm_set_epi16(
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha),
+		static_cast<short>(colour.a * alpha), static_cast<short>(colour.b * alpha), static_cast<short>(colour.g * alpha), static_cast<short>(colour.r * alpha)) };
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i pixels { _mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i)) };
+		const __m128i low { Div255(_mm_add_epi16(premultiplied, _mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse16))) };
+		const __m128i high { Div255(_mm_add_epi16(premultiplied, _mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse16))) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(low, high));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		Color& pixel { destination[i] };
+		pixel.r = static_cast<unsigned char>(Div255(colour.r * alpha + pixel.r * inverse));
+		pixel.g = static_cast<unsigned char>(Div255(colour.g * alpha + pixel.g * inverse));
+		pixel.b = static_cast<unsigned char>(Div255(colour.b * alpha + pixel.b * inverse));
+		pixel.a = static_cast<unsigned char>(Div255(colour.a * alpha + pixel.a * inverse));
+	}
+}
+
+// The first and one past the last pixel whose centre is inside [start, start + size)
+static inline void CoveredSpan(float start, float size, int limit, int& first, int& last)
+{
+	first = std::max(0, static_cast<int>(std::ceil(start - 0.5f)));
+	last = std::min(limit, static_cast<int>(std::ceil(start + size - 0.5f)));
+}
+
+// Same as raylib's GetGlyphIndex, '?' for anything the font doesn't have
+static int GlyphIndex(const Font& font, int codepoint)
+{
+	int fallback { 0 };
+	for (int i { 0 }; i < font.glyphCount; i++)
+	{
+		if (font.glyphs[i].value == codepoint) return i;
+		if (font.glyphs[i].value == '?') fallback = i;
+	}
+	return fallback;
+}
+
+SoftwareRenderBackend::SoftwareRenderBackend(int width, int height)
+	: m_Width { width }, m_Height { height }
+{
+	m_Pixels.assign(static_cast<size_t>(width) * static_cast<size_t>(height), BLANK);
+	m_Columns.resize(static_cast<size_t>(width));
+	m_RowTexels.resize(static_cast<size_t>(width));
+}
+
+void SoftwareRenderBackend::SetTexture(unsigned int id, int width, int height, std::span<const Color> pixels)
+{
+	if (id >= m_Textures.size())
+	{
+		m_Textures.resize(id + 1);
+	}
+
+	SoftwareTexture& texture { m_Textures[id] };
+	texture.width = width;
+	texture.height = height;
+	texture.pixels.assign(pixels.begin(), pixels.begin() + static_cast<std::ptrdiff_t>(width) * height);
+}
+
+void SoftwareRenderBackend::Clear(Color colour)
+{
+	std::fill(m_Pixels.begin(), m_Pixels.end(), colour);
+}
+
+void SoftwareRenderBackend::DrawSprite(const Texture2D& texture, const Rectangle& source, const Rectangle& destination, Color tint)
+{
+	// Anything without a CPU copy is skipped, e.g. a render texture nobody has mirrored
+	if (texture.id >= m_Textures.size() || m_Textures[texture.id].pixels.empty()) return;
+	if (destination.width <= 0.0f || destination.height <= 0.0f || source.width == 0.0f || source.height == 0.0f) return;
+
+	int x0, x1, y0, y1;
+	CoveredSpan(destination.x, destination.width, m_Width, x0, x1);
+	CoveredSpan(destination.y, destination.height, m_Height, y0, y1);
+	if (x0 >= x1 || y0 >= y1) return;
+
+	BlendRect(x0, y0, x1, y1, m_Textures[texture.id], source, destination, tint);
+}
+
+/*
+* Each covered pixel samples the texel under its centre. A negative source size starts from
+* the far edge and steps backwards, the same way raylib flips its texture coordinates, and
+* samples outside the texture are clamped to its edge like GL_CLAMP_TO_EDGE.
+*/
+void SoftwareRenderBackend::BlendRect(int x0, int y0, int x1, int y1, const SoftwareTexture& texture,
+	const Rectangle& source, const Rectangle& destination, Color tint)
+{
+	const float stepX { source.width / destination.width };
+	const float stepY { source.height / destination.height };
+	const float originX { source.width < 0.0f ? source.x - source.width : source.x };
+	const float originY { source.height < 0.0f ? source.y - source.height : source.y };
+
+	const size_t count { static_cast<size_t>(x1 - x0) };
+	const int firstColumn { static_cast<int>(std::floor(originX + (static_cast<float>(x0) + 0.5f - destination.x) * stepX)) };
+
+	// Drawn at its own size and all inside the texture (every sprite the game draws unscaled),
+	// each row blends straight out of the texture
+	const bool direct { stepX == 1.0f && firstColumn >= 0 && firstColumn + static_cast<int>(count) <= texture.width };
+	if (!direct)
+	{
+		for (size_t i { 0 }; i < count; i++)
+		{
+			const float u { originX + (static_cast<float>(x0 + static_cast<int>(i)) + 0.5f - destination.x) * stepX };
+			m_Columns[i] = std::clamp(static_cast<int>(std::floor(u)), 0, texture.width - 1);
+		}
+	}
+
+	for (int y { y0 }; y < y1; y++)
+	{
+		const float v { originY + (static_cast<float>(y) + 0.5f - destination.y) * stepY };
+		const int row { std::clamp(static_cast<int>(std::floor(v)), 0, texture.height - 1) };
+		const Color* texels { texture.pixels.data() + static_cast<size_t>(row) * static_cast<size_t>(texture.width) };
+		Color* pixels { m_Pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(m_Width) + static_cast<size_t>(x0) };
+
+		if (direct)
+		{
+			BlendRow(pixels, texels + firstColumn, count, tint);
+			continue;
+		}
+
+		for (size_t i { 0 }; i < count; i++)
+		{
+			m_RowTexels[i] = texels[m_Columns[i]];
+		}
+		BlendRow(pixels, m_RowTexels.data(), count, tint);
+	}
+}
+
+void SoftwareRenderBackend::FillRectangle(const Rectangle& rectangle, Color colour)
+{
+	if (colour.a == 0) return;
+
+	int x0, x1, y0, y1;
+	CoveredSpan(rectangle.x, rectangle.width, m_Width, x0, x1);
+	CoveredSpan(rectangle.y, rectangle.height, m_Height, y0, y1);
+	if (x0 >= x1 || y0 >= y1) return;
+
+	const size_t count { static_cast<size_t>(x1 - x0) };
+	for (int y { y0 }; y < y1; y++)
+	{
+		Color* pixels { m_Pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(m_Width) + static_cast<size_t>(x0) };
+		if (colour.a == 255)
+		{
+			std::fill_n(pixels, count, colour);
+		}
+		else
+		{
+			BlendColourRow(pixels, count, colour);
+		}
+	}
+}
+
+/*
+* Same layout as raylib's DrawTextEx, a sprite per glyph from the font's texture. The
+* game's text is ASCII so every byte is a codepoint, like UIText.
+*/
+void SoftwareRenderBackend::DrawTextRun(const Font& font, const char* text, Vector2 position, float fontSize, float spacing, Color colour)
+{
+	// raylib's default line spacing, nothing in the game changes it
+	constexpr float lineSpacing { 2.0f };
+
+	const float scaleFactor { fontSize / static_cast<float>(font.baseSize) };
+	const float padding { static_cast<float>(font.glyphPadding) };
+
+	float offsetX { 0.0f };
+	float offsetY { 0.0f };
+	for (const char* c { text }; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			offsetY += fontSize + lineSpacing;
+			offsetX = 0.0f;
+			continue;
+		}
+
+		const int index { GlyphIndex(font, static_cast<unsigned char>(*c)) };
+		const GlyphInfo& info { font.glyphs[index] };
+		const Rectangle& rec { font.recs[index] };
+
+		if (*c != ' ' && *c != '\t')
+		{
+			const Rectangle source { rec.x - padding, rec.y - padding, rec.width + 2.0f * padding, rec.height + 2.0f * padding };
+			const Rectangle destination {
+				position.x + offsetX + (static_cast<float>(info.offsetX) - padding) * scaleFactor,
+				position.y + offsetY + (static_cast<float>(info.offsetY) - padding) * scaleFactor,
+				source.width * scaleFactor,
+				source.height * scaleFactor
+			};
+			DrawSprite(font.texture, source, destination, colour);
+		}
+
+		const float advance { info.advanceX == 0 ? rec.width : static_cast<float>(info.advanceX) };
+		offsetX += advance * scaleFactor + spacing;
+	}
+}
+
+uint64_t SoftwareRenderBackend::GetHash() const
+{
+	const uint8_t* bytes { reinterpret_cast<const uint8_t*>(m_Pixels.data()) };
+	const size_t size { m_Pixels.size() * sizeof(Color) };
+
+	uint64_t hash { 14695981039346656037ull };
+	for (size_t i { 0 }; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+bool SoftwareRenderBackend::WritePPM(const char* path) const
+{
+	FILE* file { std::fopen(path, "wb") };
+	if (file == nullptr) return false;
+
+	std::fprintf(file, "P6\n%d %d\n255\n", m_Width, m_Height);
+
+	std::vector<uint8_t> row(static_cast<size_t>(m_Width) * 3);
+	for (int y { 0 }; y < m_Height; y++)
+	{
+		const Color* pixels { m_Pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(m_Width) };
+		for (int x { 0 }; x < m_Width; x++)
+		{
+			row[static_cast<size_t>(x) * 3 + 0] = pixels[x].r;
+			row[static_cast<size_t>(x) * 3 + 1] = pixels[x].g;
+			row[static_cast<size_t>(x) * 3 + 2] = pixels[x].b;
+		}
+		std::fwrite(row.data(), 1, row.size(), file);
+	}
+
+	const bool ok { std::ferror(file) == 0 };
+	std::fclose(file);
+	return ok;
+}
+
+const char* SoftwareBlitImplementation()
+{
+#if defined(SOFTWARE_BLIT_AVX2)
+	return "avx2";
+#elif defined(SOFTWARE_BLIT_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
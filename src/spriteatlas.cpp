@@ -0,0 +1,134 @@
+#include "spriteatlas.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+SpriteID SpriteAtlas::Add(const char* path)
+{
+	return Add(LoadImage(path));
+}
+
+SpriteID SpriteAtlas::Add(Image image, bool owned)
+{
+	// A failed load comes back empty, a magenta pixel in its place keeps the ID valid and shows up on screen
+	if (image.data == nullptr || image.width <= 0 || image.height <= 0)
+	{
+		TraceLog(LOG_WARNING, "ATLAS: Sprite %zu has no pixels, using a placeholder", m_Images.size());
+		if (owned) UnloadImage(image);
+		image = GenImageColor(1, 1, MAGENTA);
+		owned = true;
+	}
+
+	if (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+	{
+		// Converting in place would free pixels we don't own
+		if (!owned)
+		{
+			image = ImageCopy(image);
+			owned = true;
+		}
+		ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	}
+
+	m_Images.push_back(image);
+	m_OwnsImage.push_back(owned);
+	m_Sources.push_back(Rectangle { 0.0f, 0.0f, static_cast<float>(image.width), static_cast<float>(image.height) });
+	return static_cast<SpriteID>(m_Images.size() - 1);
+}
+
+void SpriteAtlas::Build()
+{
+	if (m_Images.empty()) return;
+
+	// Tallest first keeps the shelves tight
+	std::vector<size_t> order(m_Images.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return m_Images[a].height > m_Images[b].height; });
+
+	int totalArea { 0 };
+	int widestSprite { 0 };
+	for (const Image& image : m_Images)
+	{
+		const int paddedWidth { image.width + m_Padding * 2 };
+		totalArea += paddedWidth * (image.height + m_Padding * 2);
+		widestSprite = std::max(widestSprite, paddedWidth);
+	}
+
+	// Roughly square, power of two wide so it's friendly to older GL/WebGL
+	const int atlasWidth { static_cast<int>(std::bit_ceil(static_cast<unsigned int>(
+		std::max(widestSprite, static_cast<int>(std::ceil(std::sqrt(static_cast<float>(totalArea)))))))) };
+
+	// Place sprites on shelves, a new shelf starts when the current one is full
+	int shelfX { 0 };
+	int shelfY { 0 };
+	int shelfHeight { 0 };
+	for (size_t sprite : order)
+	{
+		const Image& image { m_Images[sprite] };
+		const int paddedWidth { image.width + m_Padding * 2 };
+		const int paddedHeight { image.height + m_Padding * 2 };
+
+		if (shelfX + paddedWidth > atlasWidth)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		m_Sources[sprite].x = static_cast<float>(shelfX + m_Padding);
+		m_Sources[sprite].y = static_cast<float>(shelfY + m_Padding);
+		shelfX += paddedWidth;
+		shelfHeight = std::max(shelfHeight, paddedHeight);
+	}
+
+	const int atlasHeight { static_cast<int>(std::bit_ceil(static_cast<unsigned int>(shelfY + shelfHeight))) };
+
+	Image atlas { GenImageColor(atlasWidth, atlasHeight, BLANK) };
+	Color* atlasPixels { static_cast<Color*>(atlas.data) };
+
+	for (size_t sprite { 0 }; sprite < m_Images.size(); sprite++)
+	{
+		const Image& image { m_Images[sprite] };
+		const Color* spritePixels { static_cast<const Color*>(image.data) };
+		const int originX { static_cast<int>(m_Sources[sprite].x) };
+		const int originY { static_cast<int>(m_Sources[sprite].y) };
+
+		// Includes the border, clamping the source coordinate repeats the edge pixels into it
+		for (int y { -m_Padding }; y < image.height + m_Padding; y++)
+		{
+			const int sourceY { std::clamp(y, 0, image.height - 1) };
+			for (int x { -m_Padding }; x < image.width + m_Padding; x++)
+			{
+				const int sourceX { std::clamp(x, 0, image.width - 1) };
+				atlasPixels[(originY + y) * atlasWidth + (originX + x)] = spritePixels[sourceY * image.width + sourceX];
+			}
+		}
+
+		if (m_OwnsImage[sprite]) UnloadImage(image);
+	}
+	m_Images.clear();
+	m_OwnsImage.clear();
+
+	m_Texture = LoadTextureFromImage(atlas);
+	UnloadImage(atlas);
+
+	TraceLog(LOG_INFO, "ATLAS: Packed %zu sprites into %dx%d", m_Sources.size(), atlasWidth, atlasHeight);
+}
+
+void SpriteAtlas::Unload()
+{
+	for (size_t sprite { 0 }; sprite < m_Images.size(); sprite++)
+	{
+		if (m_OwnsImage[sprite]) UnloadImage(m_Images[sprite]);
+	}
+	m_Images.clear();
+	m_OwnsImage.clear();
+
+	if (m_Texture.id != 0)
+	{
+		UnloadTexture(m_Texture);
+		m_Texture = Texture2D { 0 };
+	}
+	m_Sources.clear();
+}
@@ -0,0 +1,95 @@
+#include "uitext.h"
+#include <charconv>
+#include <cstring>
+
+void UIText::Init(const Font& font, float fontSize, float spacing, Color colour)
+{
+	m_Font = &font;
+	m_FontSize = fontSize;
+	m_Spacing = spacing;
+	m_Colour = colour;
+	m_Glyphs.reserve(m_MaxLength);
+	m_Dirty = true;
+}
+
+bool UIText::SetText(const char* text)
+{
+	m_HasValue = false;
+	if (std::strncmp(m_Text, text, m_MaxLength) == 0) return false;
+
+	std::strncpy(m_Text, text, m_MaxLength);
+	m_Text[m_MaxLength] = '\0';
+	m_Dirty = true;
+	return true;
+}
+
+bool UIText::SetValue(int value)
+{
+	if (m_HasValue && m_Value == value) return false;
+
+	const std::to_chars_result result { std::to_chars(m_Text, m_Text + m_MaxLength, value) };
+	*result.ptr = '\0';
+	m_Value = value;
+	m_HasValue = true;
+	m_Dirty = true;
+	return true;
+}
+
+Vector2 UIText::GetSize()
+{
+	if (m_Dirty) Rebuild();
+	return m_Size;
+}
+
+void UIText::Push(RenderQueue& renderQueue, RenderLayer layer)
+{
+	if (m_Dirty) Rebuild();
+
+	for (const Glyph& glyph : m_Glyphs)
+	{
+		const Rectangle destination { m_Position.x + glyph.destination.x, m_Position.y + glyph.destination.y,
+			glyph.destination.width, glyph.destination.height };
+		renderQueue.PushSprite(layer, m_Font->texture, glyph.source, destination, m_Colour);
+	}
+}
+
+/*
+* Same layout as raylib's DrawTextEx/DrawTextCodepoint, just done once up front.
+* The text is ASCII so every byte is a codepoint.
+*/
+void UIText::Rebuild()
+{
+	m_Dirty = false;
+	m_Glyphs.clear();
+
+	const Font& font { *m_Font };
+	const float scaleFactor { m_FontSize / static_cast<float>(font.baseSize) };
+	const float padding { static_cast<float>(font.glyphPadding) };
+
+	float offsetX { 0.0f };
+	for (const char* c { m_Text }; *c != '\0'; c++)
+	{
+		const int index { GetGlyphIndex(font, *c) };
+		const GlyphInfo& info { font.glyphs[index] };
+		const Rectangle& rec { font.recs[index] };
+
+		if (*c != ' ' && *c != '\t')
+		{
+			Glyph glyph;
+			glyph.source = { rec.x - padding, rec.y - padding, rec.width + 2.0f * padding, rec.height + 2.0f * padding };
+			glyph.destination = {
+				offsetX + (static_cast<float>(info.offsetX) - padding) * scaleFactor,
+				(static_cast<float>(info.offsetY) - padding) * scaleFactor,
+				glyph.source.width * scaleFactor,
+				glyph.source.height * scaleFactor
+			};
+			m_Glyphs.push_back(glyph);
+		}
+
+		const float advance { info.advanceX == 0 ? rec.width : static_cast<float>(info.advanceX) };
+		offsetX += advance * scaleFactor + m_Spacing;
+	}
+
+	// Measured once here rather than every frame
+	m_Size = MeasureTextEx(font, m_Text, m_FontSize, m_Spacing);
+}
@@ -0,0 +1,191 @@
+#include "raylib.h"
+#include "assetarchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+* Bakes the assets directory into a single archive of already decoded data (see
+* assetarchive.h) so the game does one file open and no decoding at startup.
+* PNGs become RGBA8 pixels, WAVs become raw PCM and TTFs are rasterised into a glyph
+* atlas at the size the game uses. Anything else (e.g. the .ico) is skipped.
+*
+* Usage: breakout_assetbaker <assets directory> <output file>
+*/
+
+struct BakedEntry
+{
+	ArchiveEntry entry;
+	std::vector<uint8_t> data;
+};
+
+static void AppendBytes(std::vector<uint8_t>& data, const void* bytes, size_t size)
+{
+	const uint8_t* begin { static_cast<const uint8_t*>(bytes) };
+	data.insert(data.end(), begin, begin + size);
+}
+
+static bool BakeImage(const std::string& path, BakedEntry& baked)
+{
+	Image image { LoadImage(path.c_str()) };
+	if (image.data == nullptr) return false;
+
+	ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+	baked.entry.type = ARCHIVE_ENTRY_IMAGE;
+	baked.entry.width = image.width;
+	baked.entry.height = image.height;
+	baked.entry.format = image.format;
+	AppendBytes(baked.data, image.data, static_cast<size_t>(GetPixelDataSize(image.width, image.height, image.format)));
+
+	UnloadImage(image);
+	return true;
+}
+
+static bool BakeWave(const std::string& path, BakedEntry& baked)
+{
+	Wave wave { LoadWave(path.c_str()) };
+	if (wave.data == nullptr) return false;
+
+	baked.entry.type = ARCHIVE_ENTRY_WAVE;
+	baked.entry.frameCount = wave.frameCount;
+	baked.entry.sampleRate = wave.sampleRate;
+	baked.entry.sampleSize = wave.sampleSize;
+	baked.entry.channels = wave.channels;
+	AppendBytes(baked.data, wave.data, static_cast<size_t>(wave.frameCount) * wave.channels * (wave.sampleSize / 8));
+
+	UnloadWave(wave);
+	return true;
+}
+
+static bool BakeFont(const std::string& path, BakedEntry& baked)
+{
+	// Same padding LoadFontEx uses for TTF glyphs
+	constexpr int glyphPadding { 4 };
+
+	int dataSize { 0 };
+	unsigned char* fileData { LoadFileData(path.c_str(), &dataSize) };
+	if (fileData == nullptr) return false;
+
+	GlyphInfo* glyphs { LoadFontData(fileData, dataSize, ArchiveFontSize, nullptr, ArchiveFontGlyphCount, FONT_DEFAULT) };
+	UnloadFileData(fileData);
+	if (glyphs == nullptr) return false;
+
+	Rectangle* recs { nullptr };
+	Image atlas { GenImageFontAtlas(glyphs, &recs, ArchiveFontGlyphCount, ArchiveFontSize, glyphPadding, 0) };
+
+	baked.entry.type = ARCHIVE_ENTRY_FONT;
+	baked.entry.width = atlas.width;
+	baked.entry.height = atlas.height;
+	baked.entry.format = atlas.format;
+	baked.entry.fontSize = ArchiveFontSize;
+	baked.entry.glyphCount = ArchiveFontGlyphCount;
+	baked.entry.glyphPadding = glyphPadding;
+
+	for (int i { 0 }; i < ArchiveFontGlyphCount; i++)
+	{
+		const ArchiveGlyph glyph { glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX,
+			recs[i].x, recs[i].y, recs[i].width, recs[i].height };
+		AppendBytes(baked.data, &glyph, sizeof(glyph));
+	}
+	AppendBytes(baked.data, atlas.data, static_cast<size_t>(GetPixelDataSize(atlas.width, atlas.height, atlas.format)));
+
+	UnloadImage(atlas);
+	MemFree(recs);
+	UnloadFontData(glyphs, ArchiveFontGlyphCount);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		std::fprintf(stderr, "Usage: %s <assets directory> <output file>\n", argv[0]);
+		return 1;
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	const std::filesystem::path assetsDirectory { argv[1] };
+	std::vector<std::filesystem::path> files;
+	for (const std::filesystem::directory_entry& file : std::filesystem::recursive_directory_iterator(assetsDirectory))
+	{
+		if (file.is_regular_file()) files.push_back(file.path());
+	}
+
+	// Sorted so the archive is the same byte for byte however the filesystem orders things
+	std::sort(files.begin(), files.end());
+
+	std::vector<BakedEntry> entries;
+	for (const std::filesystem::path& file : files)
+	{
+		const std::string extension { file.extension().string() };
+		const std::string name { std::filesystem::relative(file, assetsDirectory).generic_string() };
+
+		BakedEntry baked {};
+		bool ok { false };
+		if (extension == ".png") ok = BakeImage(file.string(), baked);
+		else if (extension == ".wav") ok = BakeWave(file.string(), baked);
+		else if (extension == ".ttf") ok = BakeFont(file.string(), baked);
+		else continue;
+
+		if (!ok)
+		{
+			std::fprintf(stderr, "Failed to bake %s\n", name.c_str());
+			return 1;
+		}
+
+		if (name.size() >= sizeof(baked.entry.name))
+		{
+			std::fprintf(stderr, "Asset name too long for the archive: %s\n", name.c_str());
+			return 1;
+		}
+
+		std::strncpy(baked.entry.name, name.c_str(), sizeof(baked.entry.name) - 1);
+		entries.push_back(std::move(baked));
+	}
+
+	auto Align { [](uint64_t offset) { return (offset + ArchiveAlignment - 1) & ~(ArchiveAlignment - 1); } };
+
+	uint64_t offset { Align(sizeof(ArchiveHeader) + entries.size() * sizeof(ArchiveEntry)) };
+	for (BakedEntry& baked : entries)
+	{
+		baked.entry.offset = offset;
+		baked.entry.size = baked.data.size();
+		offset = Align(offset + baked.data.size());
+	}
+
+	std::ofstream output { argv[2], std::ios::binary | std::ios::trunc };
+	if (!output)
+	{
+		std::fprintf(stderr, "Couldn't open %s for writing\n", argv[2]);
+		return 1;
+	}
+
+	const ArchiveHeader header { ArchiveMagic, ArchiveVersion, static_cast<uint32_t>(entries.size()), 0 };
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const BakedEntry& baked : entries)
+	{
+		output.write(reinterpret_cast<const char*>(&baked.entry), sizeof(baked.entry));
+	}
+
+	const char padding[ArchiveAlignment] {};
+	for (const BakedEntry& baked : entries)
+	{
+		output.write(padding, static_cast<std::streamsize>(baked.entry.offset - static_cast<uint64_t>(output.tellp())));
+		output.write(reinterpret_cast<const char*>(baked.data.data()), static_cast<std::streamsize>(baked.data.size()));
+	}
+
+	if (!output)
+	{
+		std::fprintf(stderr, "Failed writing %s\n", argv[2]);
+		return 1;
+	}
+
+	std::printf("Baked %zu assets into %s (%llu bytes)\n", entries.size(), argv[2], static_cast<unsigned long long>(output.tellp()));
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include "level.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+* Makes level files (see level.h) for --level, either from text or generated.
+
+* Text levels are one line per row of bricks. Each cell is two hex digits, the brick type
+* (which sprite it's drawn with) then its hit points, or ".." for an empty cell. Spaces
+* are ignored so cells can be lined up, lines starting with # are comments. Rows can be
+* different lengths, the level is as wide as the longest.
+
+*	# a wall with a tougher middle
+*	01 01 01 01 01 01
+*	11 11 13 13 11 11
+*	.. 21 21 21 21 ..
+
+* --random fills a columns x rows level, each cell has a brick with the given probability.
+* Types go in bands of rows like the classic levels and hit points are 1-3, so the big
+* challenge levels don't have to be written by hand.
+*
+* Usage: breakout_levelbaker <level.txt> <output file>
+*        breakout_levelbaker --random <columns> <rows> <density> <seed> <output file>
+*/
+
+static int HexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+static bool ParseText(const char* path, BrickField& field)
+{
+	std::ifstream input { path };
+	if (!input)
+	{
+		std::fprintf(stderr, "Couldn't open %s\n", path);
+		return false;
+	}
+
+	// Parsed into a list first since the size isn't known until the end
+	struct ParsedBrick
+	{
+		int column;
+		int row;
+		BrickCell cell;
+	};
+	std::vector<ParsedBrick> bricks;
+	int columns { 0 };
+	int rows { 0 };
+
+	std::string line;
+	int lineNumber { 0 };
+	while (std::getline(input, line))
+	{
+		lineNumber++;
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (!line.empty() && line.front() == '#') continue;
+
+		std::string cells;
+		for (char c : line)
+		{
+			if (c != ' ' && c != '\t') cells.push_back(c);
+		}
+
+		if (cells.size() % 2 != 0)
+		{
+			std::fprintf(stderr, "%s:%d: odd number of digits, every cell is two\n", path, lineNumber);
+			return false;
+		}
+
+		for (size_t i { 0 }; i < cells.size(); i += 2)
+		{
+			const int column { static_cast<int>(i / 2) };
+			if (cells[i] == '.' && cells[i + 1] == '.') continue;
+
+			const int type { HexDigit(cells[i]) };
+			const int hitPoints { HexDigit(cells[i + 1]) };
+			if (type < 0 || hitPoints < 1)
+			{
+				std::fprintf(stderr, "%s:%d: bad cell '%c%c' in column %d\n", path, lineNumber, cells[i], cells[i + 1], column);
+				return false;
+			}
+
+			bricks.push_back({ column, rows, BrickCell { static_cast<uint8_t>(type), static_cast<uint8_t>(hitPoints) } });
+		}
+
+		columns = std::max(columns, static_cast<int>(cells.size() / 2));
+		rows++;
+	}
+
+	field.Reset(columns, rows);
+	for (const ParsedBrick& brick : bricks)
+	{
+		field.Set(brick.column, brick.row, brick.cell);
+	}
+	return true;
+}
+
+static void Generate(int columns, int rows, double density, uint32_t seed, BrickField& field)
+{
+	std::mt19937 random { seed };
+	std::bernoulli_distribution hasBrick { density };
+	std::uniform_int_distribution<int> hitPoints { 1, 3 };
+
+	// Four type bands from top to bottom, however tall the level is
+	field.Reset(columns, rows);
+	for (int row { 0 }; row < rows; row++)
+	{
+		const uint8_t type { static_cast<uint8_t>(row * 4 / std::max(1, rows)) };
+		for (int column { 0 }; column < columns; column++)
+		{
+			if (hasBrick(random))
+			{
+				field.Set(column, row, BrickCell { type, static_cast<uint8_t>(hitPoints(random)) });
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BrickField field;
+	const char* outputPath { nullptr };
+
+	if (argc == 7 && std::strcmp(argv[1], "--random") == 0)
+	{
+		const int columns { std::atoi(argv[2]) };
+		const int rows { std::atoi(argv[3]) };
+		if (columns <= 0 || rows <= 0 || columns > static_cast<int>(MaxLevelSize) || rows > static_cast<int>(MaxLevelSize))
+		{
+			std::fprintf(stderr, "Levels are 1 to %u cells a side\n", MaxLevelSize);
+			return 1;
+		}
+
+		Generate(columns, rows, std::atof(argv[4]), static_cast<uint32_t>(std::strtoul(argv[5], nullptr, 10)), field);
+		outputPath = argv[6];
+	}
+	else if (argc == 3)
+	{
+		if (!ParseText(argv[1], field)) return 1;
+		outputPath = argv[2];
+	}
+	else
+	{
+		std::fprintf(stderr, "Usage: %s <level.txt> <output file>\n", argv[0]);
+		std::fprintf(stderr, "       %s --random <columns> <rows> <density> <seed> <output file>\n", argv[0]);
+		return 1;
+	}
+
+	if (field.IsEmpty())
+	{
+		std::fprintf(stderr, "The level has no bricks\n");
+		return 1;
+	}
+
+	if (!SaveLevel(outputPath, field))
+	{
+		std::fprintf(stderr, "Couldn't write %s\n", outputPath);
+		return 1;
+	}
+
+	std::printf("Baked %dx%d level with %zu bricks to %s\n", field.GetColumns(), field.GetRows(), field.GetLiveCount(), outputPath);
+	return 0;
+}